@@ -0,0 +1,42 @@
+// broker.cpp
+// author:  Joseph Perry
+// desc:    An example of how to use the Broker class defined in broker.h,
+//          replaying the three smokers and one merchant as a broker workload
+
+#include "broker.h"
+#include <thread>
+#include <random>
+
+int main(){
+  enum { Paper, Tobacco, Lighter, Num_items };
+  Broker broker(Num_items);
+  std::vector<Agent> smokers = { Agent(0, make_bundle({ Tobacco, Lighter })),
+                                 Agent(1, make_bundle({ Paper, Lighter })),
+                                 Agent(2, make_bundle({ Paper, Tobacco })) };
+  std::vector<std::thread> threads;
+  std::mt19937 rng(1);
+  int rounds = 30;
+
+  for(Agent &smoker : smokers)
+    threads.push_back(std::thread([&smoker, &broker](){ while(smoker.can_consume(broker)); }));
+
+  // the merchant publishes the bundle of a random smoker
+  for(int i = 0; i < rounds; ++i){
+    Agent &smoker = smokers[rng() % smokers.size()];
+
+    for(const auto &need : smoker.needs())
+      broker.publish(need.first, need.second);
+
+    while(broker.available(Paper) + broker.available(Tobacco) + broker.available(Lighter) > 0)
+      std::this_thread::yield();
+  }
+  broker.close();
+
+  for(auto &t : threads)
+    t.join();
+
+  for(size_t i = 0; i < smokers.size(); ++i)
+    std::cout << i << ": " << smokers[i].grants() << " grants\n";
+
+  return 0;
+}
@@ -0,0 +1,411 @@
+// broker.h
+// author:  Joseph Perry
+// desc:    This file defines a Broker that generalizes the cigarette smokers
+//          problem (see smoker/smoker.h) to any number of resources, producers
+//          and agents. Agents declare the bundle of resources they need,
+//          producers publish resources, and the broker hands out complete
+//          bundles.
+//
+//          Every resource is a shard with its own lock, count and queue of
+//          waiting requests. A bundle only locks the shards it names, in
+//          ascending order, so agents with disjoint bundles run in parallel.
+//          Bundles not built by make_bundle are sorted and merged first, and
+//          naming a resource that does not exist throws std::out_of_range.
+//          Waiters are served first-fit in arrival order: the oldest waiter
+//          whose whole bundle is available is granted first, and a waiter
+//          that cannot be served does not block later ones. To bound latency,
+//          a waiter that has been overtaken max_bypass times reserves its
+//          resources so nobody behind it may take them. The default bound is
+//          DEFAULT_MAX_BYPASS, 0 disables it.
+//          Requires C++17.
+
+#ifndef BROKER_H
+#define BROKER_H
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+// a bundle is a list of (resource, amount) pairs
+typedef std::vector<std::pair<int, int>> Bundle;
+
+// builds a bundle from a list of resource ids, repeated ids ask for more than one unit
+Bundle make_bundle(std::vector<int> resources){
+  Bundle bundle;
+
+  std::sort(resources.begin(), resources.end());
+  for(int r : resources){
+    if(!bundle.empty() && bundle.back().first == r)
+      ++bundle.back().second;
+    else
+      bundle.push_back(std::make_pair(r, 1));
+  }
+
+  return bundle;
+}
+
+class Broker {
+  public:
+    // overtakes a waiter may suffer before its resources are reserved
+    static const int DEFAULT_MAX_BYPASS = 16;
+
+    // constructor, resources are numbered [0, num_resources), max_bypass 0 is unbounded
+    Broker(int, int = DEFAULT_MAX_BYPASS);
+
+    // take the bundle, blocking until it is granted; false once closed
+    bool acquire(const Bundle&);
+
+    // take the bundle only if it can be granted right away
+    bool try_acquire(const Bundle&);
+
+    // add count units of resource and serve any waiters that became satisfiable
+    void publish(int, int = 1);
+
+    // give a bundle back, equivalent to publishing each of its resources
+    void release(const Bundle&);
+
+    // fail every waiting and future blocking acquire
+    void close();
+
+    // getter for the number of units of resource currently available
+    long available(int);
+
+    // getter for the number of resources
+    size_t inline resources(){ return shards.size(); }
+
+  private:
+    // a blocked acquire, lives on the waiting thread's stack until granted
+    enum class Request_state : int { Waiting, Granted, Closed };
+    struct Request {
+      const Bundle *bundle;
+      uint64_t seq;
+      std::atomic<int> bypassed;                  // times a later request overtook this one, charged by
+                                                  // grants that hold other shards, so atomic
+      Request_state state;
+      std::mutex mtx;
+      std::condition_variable cv;
+    };
+
+    // one resource, padded to a cache line so shards do not false-share
+    struct alignas(64) Shard {
+      std::mutex mtx;
+      long count;
+      std::deque<Request*> waiters;
+    };
+
+    std::vector<Shard> shards;
+    int max_bypass;
+    std::atomic<uint64_t> next_seq;
+    std::atomic<bool> closed;
+
+    const Bundle& normalize(const Bundle&, Bundle&);
+    void lock(const Bundle&);
+    void unlock(const Bundle&);
+    bool grantable(const Bundle&, Request*);      // counts available and not reserved by an older waiter
+    void grant(const Bundle&, Request*);          // take the counts and dequeue req
+    void signal(Request*, Request_state);
+    void dispatch(int);                           // serve the waiters of a resource
+};
+
+// constructor
+Broker::Broker(int num_resources, int max_bypass) : shards(num_resources), max_bypass(max_bypass), next_seq(0), closed(false) {
+  for(Shard &shard : shards)
+    shard.count = 0;
+}
+
+// returns bundle if it is already in lock order (ascending, unique ids, as
+// make_bundle builds them), otherwise a sorted and merged copy in scratch
+const Bundle& Broker::normalize(const Bundle &bundle, Bundle &scratch){
+  bool sorted = true;
+
+  for(size_t i = 0; i < bundle.size(); ++i){
+    if(bundle[i].first < 0 || bundle[i].first >= static_cast<int>(shards.size()))
+      throw std::out_of_range("Broker: no such resource");
+    if(i > 0 && bundle[i - 1].first >= bundle[i].first)
+      sorted = false;
+  }
+  if(sorted)
+    return bundle;
+
+  scratch = bundle;
+  std::sort(scratch.begin(), scratch.end());
+  size_t n = 0;
+  for(const auto &need : scratch){
+    if(n > 0 && scratch[n - 1].first == need.first)
+      scratch[n - 1].second += need.second;
+    else
+      scratch[n++] = need;
+  }
+  scratch.resize(n);
+
+  return scratch;
+}
+
+// bundles are sorted by resource, so this is the global lock order
+void Broker::lock(const Bundle &bundle){
+  for(const auto &need : bundle)
+    shards[need.first].mtx.lock();
+}
+
+void Broker::unlock(const Bundle &bundle){
+  for(auto it = bundle.rbegin(); it != bundle.rend(); ++it)
+    shards[it->first].mtx.unlock();
+}
+
+// caller holds every shard in bundle, req == nullptr is a new request behind every waiter
+bool Broker::grantable(const Bundle &bundle, Request *req){
+  for(const auto &need : bundle){
+    Shard &shard = shards[need.first];
+
+    if(shard.count < need.second)
+      return false;
+
+    // an older waiter that has been overtaken too often reserves this resource
+    if(max_bypass > 0)
+      for(Request *w : shard.waiters){
+        if(w == req)
+          break;
+        if(w->bypassed.load(std::memory_order_relaxed) >= max_bypass)
+          return false;
+      }
+  }
+
+  return true;
+}
+
+// caller holds every shard in bundle, every older waiter passed over is charged
+// one bypass, however many of the bundle's shards it is queued on
+void Broker::grant(const Bundle &bundle, Request *req){
+  std::vector<Request*> passed;
+
+  for(const auto &need : bundle){
+    Shard &shard = shards[need.first];
+
+    shard.count -= need.second;
+    for(auto it = shard.waiters.begin(); it != shard.waiters.end(); ++it){
+      if(*it == req){
+        shard.waiters.erase(it);
+        break;
+      }
+      if(max_bypass > 0)
+        passed.push_back(*it);
+    }
+  }
+
+  std::sort(passed.begin(), passed.end());
+  passed.erase(std::unique(passed.begin(), passed.end()), passed.end());
+  for(Request *w : passed)
+    w->bypassed.fetch_add(1, std::memory_order_relaxed);
+}
+
+// wake a waiter, the notify happens under its lock so it cannot return early
+void Broker::signal(Request *req, Request_state state){
+  std::lock_guard<std::mutex> lck(req->mtx);
+
+  req->state = state;
+  req->cv.notify_one();
+}
+
+bool Broker::try_acquire(const Bundle &request){
+  Bundle scratch;
+  const Bundle &bundle = normalize(request, scratch);
+  bool granted;
+
+  lock(bundle);
+  granted = grantable(bundle, nullptr);
+  if(granted)
+    grant(bundle, nullptr);
+  unlock(bundle);
+
+  return granted;
+}
+
+bool Broker::acquire(const Bundle &request){
+  Bundle scratch;
+  const Bundle &bundle = normalize(request, scratch);    // outlives req
+  Request req;
+
+  // fast path, everything is available and not reserved
+  lock(bundle);
+  if(grantable(bundle, nullptr)){
+    grant(bundle, nullptr);
+    unlock(bundle);
+    return true;
+  }
+
+  if(closed.load(std::memory_order_acquire)){
+    unlock(bundle);
+    return false;
+  }
+
+  // enqueue on every shard while holding all of them, so any two requests
+  // that share resources are queued in the same relative order everywhere
+  req.bundle = &bundle;
+  req.seq = next_seq.fetch_add(1, std::memory_order_relaxed);
+  req.bypassed.store(0, std::memory_order_relaxed);
+  req.state = Request_state::Waiting;
+  for(const auto &need : bundle)
+    shards[need.first].waiters.push_back(&req);
+  unlock(bundle);
+
+  std::unique_lock<std::mutex> lck(req.mtx);
+  while(req.state == Request_state::Waiting)
+    req.cv.wait(lck);
+
+  return req.state == Request_state::Granted;
+}
+
+void Broker::publish(int resource, int count){
+  if(resource < 0 || resource >= static_cast<int>(shards.size()))
+    throw std::out_of_range("Broker: no such resource");
+
+  {
+    std::lock_guard<std::mutex> lck(shards[resource].mtx);
+    shards[resource].count += count;
+    if(shards[resource].waiters.empty())
+      return;
+  }
+
+  dispatch(resource);
+}
+
+// checked up front, so a bad resource publishes nothing
+void Broker::release(const Bundle &request){
+  Bundle scratch;
+  const Bundle &bundle = normalize(request, scratch);
+
+  for(const auto &need : bundle)
+    publish(need.first, need.second);
+}
+
+// scans the waiters of resource oldest first and grants every one that fits.
+// A grant can lift a reservation on the other shards it touched, so those
+// are revisited, and resource itself is rescanned until a pass grants nothing.
+void Broker::dispatch(int resource){
+  struct Candidate {
+    Request *req;
+    uint64_t seq;
+    Bundle bundle;
+  };
+  std::vector<int> pending(1, resource);
+  std::vector<Candidate> candidates;
+  bool granted;
+  int r;
+
+  while(!pending.empty()){
+    r = pending.back();
+    pending.pop_back();
+
+    do {
+      granted = false;
+
+      // copy what we need, a request may be granted as soon as we let go
+      {
+        std::lock_guard<std::mutex> lck(shards[r].mtx);
+        candidates.clear();
+        if(shards[r].count <= 0)
+          break;
+        for(Request *w : shards[r].waiters)
+          candidates.push_back(Candidate{ w, w->seq, *w->bundle });
+      }
+
+      for(Candidate &c : candidates){
+        bool served;
+        long left;
+
+        lock(c.bundle);
+
+        // still queued (and therefore alive) and still the same request
+        served = std::find(shards[r].waiters.begin(), shards[r].waiters.end(), c.req) != shards[r].waiters.end()
+                 && c.req->seq == c.seq && grantable(c.bundle, c.req);
+        if(served)
+          grant(c.bundle, c.req);
+        left = shards[r].count;
+
+        unlock(c.bundle);
+
+        if(served){
+          signal(c.req, Request_state::Granted);
+          granted = true;
+          for(const auto &need : c.bundle)
+            if(need.first != r)
+              pending.push_back(need.first);
+        }
+
+        if(left <= 0)
+          break;
+      }
+    } while(granted);
+  }
+}
+
+// every queued request is unsatisfiable at this point, otherwise dispatch would
+// already have granted it, so they can all be failed
+void Broker::close(){
+  std::vector<Request*> failed;
+
+  closed.store(true, std::memory_order_release);
+
+  for(Shard &shard : shards)
+    shard.mtx.lock();
+
+  for(Shard &shard : shards){
+    for(Request *req : shard.waiters)
+      if(std::find(failed.begin(), failed.end(), req) == failed.end())
+        failed.push_back(req);
+    shard.waiters.clear();
+  }
+
+  for(auto it = shards.rbegin(); it != shards.rend(); ++it)
+    it->mtx.unlock();
+
+  for(Request *req : failed)
+    signal(req, Request_state::Closed);
+}
+
+long Broker::available(int resource){
+  std::lock_guard<std::mutex> lck(shards[resource].mtx);
+
+  return shards[resource].count;
+}
+
+// An agent repeatedly acquires its bundle, like a smoker waiting for its items
+class Agent {
+  public:
+    // constructor
+    Agent(int, Bundle);
+
+    // main loop, returns false once the broker is closed
+    bool can_consume(Broker&);
+
+    // getter for the number of bundles this agent has been granted
+    long inline grants(){ return num_grants; }
+
+    // getter for the bundle this agent needs
+    const Bundle& needs(){ return bundle; }
+
+  private:
+    int id;
+    Bundle bundle;
+    long num_grants;
+};
+
+// constructor
+Agent::Agent(int id, Bundle bundle) : id(id), bundle(bundle), num_grants(0) {}
+
+bool Agent::can_consume(Broker &broker){
+  if(!broker.acquire(bundle))
+    return false;
+
+  ++num_grants;
+  return true;
+}
+
+#endif
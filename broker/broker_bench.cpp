@@ -0,0 +1,139 @@
+// broker_bench.cpp
+// author:  Joseph Perry
+// desc:    Sweeps the number of agents and resources for the Broker defined in
+//          broker.h. Producers publish the bundles of randomly chosen agents and
+//          every agent thread acquires its bundle until the broker is closed.
+//          Reports grants/sec, fairness (min/max grants per agent) and the
+//          mean and worst acquire latency. Without a max_bypass the sweep runs
+//          with Broker::DEFAULT_MAX_BYPASS and again unbounded (0) for
+//          comparison. Requires C++17.
+//
+//          usage: ./broker_bench [bundles] [producers] [max_bypass]
+
+#include "broker.h"
+#include <thread>
+#include <random>
+#include <chrono>
+#include <sstream>
+#include <cstdio>
+
+struct Result {
+  long grants;
+  double seconds;
+  double fairness;
+  double mean_wait_ns;
+  double max_wait_ns;
+};
+
+Result run(int num_agents, int num_resources, long bundles, int num_producers, int max_bypass){
+  Broker broker(num_resources, max_bypass);
+  std::vector<Agent> agents;
+  std::vector<std::thread> threads;
+  std::vector<double> total_wait(num_agents, 0), max_wait(num_agents, 0);
+  std::mt19937 rng(num_agents * 1000 + num_resources);
+  std::chrono::steady_clock::time_point start;
+  long min_grants, max_grants;
+  Result result;
+
+  // each agent needs two distinct resources
+  for(int i = 0; i < num_agents; ++i){
+    int a = rng() % num_resources;
+    int b = (a + 1 + rng() % (num_resources - 1)) % num_resources;
+    agents.push_back(Agent(i, make_bundle({ a, b })));
+  }
+
+  start = std::chrono::steady_clock::now();
+
+  for(int i = 0; i < num_agents; ++i)
+    threads.push_back(std::thread([&, i](){
+      while(true){
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        bool granted = agents[i].can_consume(broker);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t).count();
+
+        if(!granted)
+          break;
+        total_wait[i] += ns;
+        if(ns > max_wait[i])
+          max_wait[i] = ns;
+      }
+    }));
+
+  std::vector<std::thread> producers;
+  for(int p = 0; p < num_producers; ++p)
+    producers.push_back(std::thread([&, p](){
+      std::mt19937 prng(p + 1);
+
+      for(long i = p; i < bundles; i += num_producers)
+        broker.release(agents[prng() % num_agents].needs());
+    }));
+
+  for(auto &t : producers)
+    t.join();
+  broker.close();
+  for(auto &t : threads)
+    t.join();
+
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.grants = 0;
+  result.mean_wait_ns = 0;
+  result.max_wait_ns = 0;
+  min_grants = max_grants = agents[0].grants();
+  for(int i = 0; i < num_agents; ++i){
+    result.grants += agents[i].grants();
+    result.mean_wait_ns += total_wait[i];
+    result.max_wait_ns = std::max(result.max_wait_ns, max_wait[i]);
+    min_grants = std::min(min_grants, agents[i].grants());
+    max_grants = std::max(max_grants, agents[i].grants());
+  }
+  result.mean_wait_ns /= std::max(result.grants, 1L);
+  result.fairness = max_grants > 0 ? (double)min_grants / max_grants : 0;
+
+  return result;
+}
+
+int main(int argc, char *argv[]){
+  long bundles = 200000;
+  int num_producers = 2;
+  std::vector<int> bypass_limits = { Broker::DEFAULT_MAX_BYPASS, 0 };
+  std::vector<int> agent_counts = { 4, 16, 64, 256 };
+  std::vector<int> resource_counts = { 3, 16, 64, 256 };
+
+  if(argc > 1){
+    std::istringstream ss(argv[1]);
+    if(!(ss >> bundles)){
+      std::cerr << "Invalid bundles : " << argv[1] << "\n";
+      return 1;
+    }
+  }
+  if(argc > 2){
+    std::istringstream ss(argv[2]);
+    if(!(ss >> num_producers) || num_producers < 1){
+      std::cerr << "Invalid producers : " << argv[2] << "\n";
+      return 1;
+    }
+  }
+  if(argc > 3){
+    std::istringstream ss(argv[3]);
+    int max_bypass;
+
+    if(!(ss >> max_bypass) || max_bypass < 0){
+      std::cerr << "Invalid max_bypass : " << argv[3] << "\n";
+      return 1;
+    }
+    bypass_limits = { max_bypass };
+  }
+
+  printf("%10s %7s %9s %10s %14s %9s %14s %14s\n", "max_bypass", "agents", "resources", "grants", "grants/sec", "fairness", "mean wait ns", "max wait ns");
+
+  for(int max_bypass : bypass_limits)
+    for(int num_agents : agent_counts)
+      for(int num_resources : resource_counts){
+        Result r = run(num_agents, num_resources, bundles, num_producers, max_bypass);
+
+        printf("%10d %7d %9d %10ld %14.0f %9.3f %14.0f %14.0f\n", max_bypass, num_agents, num_resources, r.grants,
+               r.grants / r.seconds, r.fairness, r.mean_wait_ns, r.max_wait_ns);
+      }
+
+  return 0;
+}
@@ -0,0 +1,426 @@
+// contention.h
+// author:  Joseph Perry
+// desc:    This file defines a lightweight instrumentation layer for mutex and
+//          condition variable sites. A ContentionSite names one place in the
+//          code that locks a mutex and possibly waits on a condition variable;
+//          a ContendedLock is used there in place of std::unique_lock and
+//          records, per thread:
+//
+//            - acquisitions, and how many of them found the mutex held
+//            - time spent blocked acquiring the mutex
+//            - time spent waiting on the condition variable, per wait
+//            - wakeups, and spurious ones (woken but the predicate was false)
+//            - time the mutex was held
+//
+//          Every thread writes only its own counters, so recording takes no
+//          lock and no atomic read-modify-write. Readers sum the per-thread
+//          counters, which makes the report and the dump safe to take while
+//          the program runs. Instrumentation is off until enabled, a disabled
+//          ContendedLock costs one relaxed load over std::unique_lock.
+//
+//          Sites must outlive every thread that records into them, in practice
+//          they are static.
+
+#ifndef CONTENTION_H
+#define CONTENTION_H
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <csignal>
+#include "run_stats.h"
+
+// histogram written by one thread and read by any
+class ContentionHistogram {
+  public:
+    ContentionHistogram();
+
+    // add one sample, only the owning thread may call this
+    void record(std::chrono::nanoseconds);
+
+    // copy of the current contents
+    LatencyHistogram snapshot() const;
+
+  private:
+    std::atomic<uint64_t> buckets[LatencyHistogram::BUCKETS];
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+};
+
+// single writer increment, a plain load and store rather than a locked add
+inline void bump(std::atomic<uint64_t> &counter, uint64_t n = 1){
+  counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+ContentionHistogram::ContentionHistogram() : sum(0), max(0) {
+  for(int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+    buckets[i].store(0, std::memory_order_relaxed);
+}
+
+void ContentionHistogram::record(std::chrono::nanoseconds d){
+  uint64_t ns = d.count() > 0 ? d.count() : 0;
+
+  bump(buckets[LatencyHistogram::bucket(ns)]);
+  bump(sum, ns);
+  if(ns > max.load(std::memory_order_relaxed))
+    max.store(ns, std::memory_order_relaxed);
+}
+
+LatencyHistogram ContentionHistogram::snapshot() const {
+  std::vector<uint64_t> raw(LatencyHistogram::BUCKETS);
+
+  for(int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+    raw[i] = buckets[i].load(std::memory_order_relaxed);
+
+  return LatencyHistogram(raw, sum.load(std::memory_order_relaxed), max.load(std::memory_order_relaxed));
+}
+
+// what one thread recorded at one site
+struct ContentionCounters {
+  std::atomic<uint64_t> acquisitions;
+  std::atomic<uint64_t> contended;          // acquisitions that found the mutex held
+  std::atomic<uint64_t> waits;              // calls to wait that had to block
+  std::atomic<uint64_t> wakeups;
+  std::atomic<uint64_t> spurious;           // wakeups that found the predicate still false
+  ContentionHistogram lock_wait;
+  ContentionHistogram cv_wait;
+  ContentionHistogram hold;
+  ContentionCounters *next;
+
+  ContentionCounters() : acquisitions(0), contended(0), waits(0), wakeups(0), spurious(0), next(nullptr) {}
+};
+
+// totals for one site, with per-thread acquisitions to judge starvation
+struct ContentionSnapshot {
+  std::string name;
+  uint64_t acquisitions;
+  uint64_t contended;
+  uint64_t waits;
+  uint64_t wakeups;
+  uint64_t spurious;
+  std::vector<uint64_t> per_thread;
+  LatencyHistogram lock_wait;
+  LatencyHistogram cv_wait;
+  LatencyHistogram hold;
+};
+
+class ContentionSite {
+  public:
+    // constructor, registers the site for reporting
+    explicit ContentionSite(const char*);
+
+    // destructor, frees every thread's counters
+    ~ContentionSite();
+
+    // the calling thread's counters, created on first use
+    ContentionCounters& local();
+
+    // sums the counters of every thread
+    ContentionSnapshot snapshot() const;
+
+    // getter for the site name
+    const char inline *label() const { return name; }
+
+    // turn recording on or off for every site
+    static void enable(bool = true);
+    static bool inline enabled(){ return on.load(std::memory_order_relaxed); }
+
+    // every registered site, oldest first
+    static std::vector<ContentionSite*> all();
+
+  private:
+    const char *name;
+    std::atomic<ContentionCounters*> threads;   // lock-free list, threads only ever push
+    ContentionSite *next;
+
+    static std::atomic<ContentionSite*> sites;
+    static std::atomic<bool> on;
+};
+
+std::atomic<ContentionSite*> ContentionSite::sites(nullptr);
+std::atomic<bool> ContentionSite::on(false);
+
+ContentionSite::ContentionSite(const char *name) : name(name), threads(nullptr) {
+  next = sites.load(std::memory_order_relaxed);
+  while(!sites.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// only runs at exit for static sites, when no thread records any more
+ContentionSite::~ContentionSite(){
+  ContentionCounters *c = threads.load(std::memory_order_acquire);
+
+  while(c != nullptr){
+    ContentionCounters *dead = c;
+    c = c->next;
+    delete dead;
+  }
+}
+
+// each thread caches its counters per site, there are only ever a handful of sites
+ContentionCounters& ContentionSite::local(){
+  thread_local std::vector<std::pair<const ContentionSite*, ContentionCounters*>> cache;
+
+  for(const auto &entry : cache)
+    if(entry.first == this)
+      return *entry.second;
+
+  ContentionCounters *c = new ContentionCounters();
+  c->next = threads.load(std::memory_order_relaxed);
+  while(!threads.compare_exchange_weak(c->next, c, std::memory_order_release, std::memory_order_relaxed));
+
+  cache.push_back(std::make_pair(this, c));
+  return *c;
+}
+
+ContentionSnapshot ContentionSite::snapshot() const {
+  ContentionSnapshot s;
+
+  s.name = name;
+  s.acquisitions = s.contended = s.waits = s.wakeups = s.spurious = 0;
+
+  for(ContentionCounters *c = threads.load(std::memory_order_acquire); c != nullptr; c = c->next){
+    uint64_t acquired = c->acquisitions.load(std::memory_order_relaxed);
+
+    s.acquisitions += acquired;
+    s.contended += c->contended.load(std::memory_order_relaxed);
+    s.waits += c->waits.load(std::memory_order_relaxed);
+    s.wakeups += c->wakeups.load(std::memory_order_relaxed);
+    s.spurious += c->spurious.load(std::memory_order_relaxed);
+    s.per_thread.push_back(acquired);
+    s.lock_wait.merge(c->lock_wait.snapshot());
+    s.cv_wait.merge(c->cv_wait.snapshot());
+    s.hold.merge(c->hold.snapshot());
+  }
+
+  return s;
+}
+
+void ContentionSite::enable(bool state){
+  on.store(state, std::memory_order_relaxed);
+}
+
+std::vector<ContentionSite*> ContentionSite::all(){
+  std::vector<ContentionSite*> result;
+
+  for(ContentionSite *s = sites.load(std::memory_order_acquire); s != nullptr; s = s->next)
+    result.insert(result.begin(), s);
+
+  return result;
+}
+
+// Drop-in for std::unique_lock<std::mutex> at an instrumented site. Waits take
+// a predicate so wakeups can be classified.
+class ContendedLock {
+  public:
+    // constructor, locks mtx
+    ContendedLock(std::mutex&, ContentionSite&);
+
+    // destructor, unlocks if still held
+    ~ContendedLock();
+
+    void lock();
+    void unlock();
+
+    // block on cv until pred holds, the mutex must be held
+    template <typename Predicate>
+    void wait(std::condition_variable&, Predicate);
+
+  private:
+    std::unique_lock<std::mutex> lck;
+    ContentionCounters *counters;               // nullptr when instrumentation is off
+    std::chrono::steady_clock::time_point acquired;
+
+    ContendedLock(const ContendedLock&);
+    ContendedLock& operator=(const ContendedLock&);
+};
+
+// constructor
+ContendedLock::ContendedLock(std::mutex &mtx, ContentionSite &site)
+  : lck(mtx, std::defer_lock), counters(ContentionSite::enabled() ? &site.local() : nullptr) {
+  lock();
+}
+
+// destructor
+ContendedLock::~ContendedLock(){
+  if(lck.owns_lock())
+    unlock();
+}
+
+// an uncontended acquisition costs one clock read, for the hold time
+void ContendedLock::lock(){
+  if(counters == nullptr){
+    lck.lock();
+    return;
+  }
+
+  if(lck.try_lock()){
+    acquired = std::chrono::steady_clock::now();
+    counters->lock_wait.record(std::chrono::nanoseconds(0));
+  } else {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    lck.lock();
+    acquired = std::chrono::steady_clock::now();
+    counters->lock_wait.record(acquired - start);
+    bump(counters->contended);
+  }
+
+  bump(counters->acquisitions);
+}
+
+void ContendedLock::unlock(){
+  if(counters != nullptr)
+    counters->hold.record(std::chrono::steady_clock::now() - acquired);
+
+  lck.unlock();
+}
+
+// the mutex is released while blocked, so the hold time is split around the wait
+template <typename Predicate>
+void ContendedLock::wait(std::condition_variable &cv, Predicate pred){
+  std::chrono::steady_clock::time_point start;
+
+  if(counters == nullptr){
+    while(!pred())
+      cv.wait(lck);
+    return;
+  }
+
+  if(pred())
+    return;
+
+  start = std::chrono::steady_clock::now();
+  counters->hold.record(start - acquired);
+  bump(counters->waits);
+
+  while(true){
+    cv.wait(lck);
+    bump(counters->wakeups);
+    if(pred())
+      break;
+    bump(counters->spurious);
+  }
+
+  acquired = std::chrono::steady_clock::now();
+  counters->cv_wait.record(acquired - start);
+}
+
+// human readable summary of every site, printed at shutdown
+void print_contention_report(std::ostream &out){
+  for(ContentionSite *site : ContentionSite::all()){
+    ContentionSnapshot s = site->snapshot();
+    uint64_t lo = 0, hi = 0;
+
+    if(s.acquisitions == 0)
+      continue;
+
+    for(size_t i = 0; i < s.per_thread.size(); ++i){
+      lo = (i == 0) ? s.per_thread[i] : std::min(lo, s.per_thread[i]);
+      hi = (i == 0) ? s.per_thread[i] : std::max(hi, s.per_thread[i]);
+    }
+
+    out << "contention at " << s.name << ": " << s.acquisitions << " acquisitions by "
+        << s.per_thread.size() << " threads, " << s.contended << " contended, fairness (min/max) "
+        << std::fixed << std::setprecision(3) << (hi > 0 ? (double)lo / hi : 0) << "\n";
+    out << "  " << s.waits << " waits, " << s.wakeups << " wakeups, " << s.spurious << " spurious\n";
+    out << " lock wait:\n";
+    s.lock_wait.print(out);
+    out << " condition wait:\n";
+    s.cv_wait.print(out);
+    out << " hold:\n";
+    s.hold.print(out);
+  }
+}
+
+// one histogram as a JSON object
+void dump_histogram(std::ostream &out, const LatencyHistogram &h){
+  out << "{\"samples\":" << h.samples() << ",\"mean\":" << std::fixed << std::setprecision(0) << h.mean()
+      << ",\"p50\":" << h.percentile(50) << ",\"p99\":" << h.percentile(99) << ",\"max\":" << h.maximum() << "}";
+}
+
+// every site as one line of JSON, safe to call while the program runs
+void dump_contention(std::ostream &out){
+  std::vector<ContentionSite*> sites = ContentionSite::all();
+
+  out << "{\"sites\":[";
+  for(size_t i = 0; i < sites.size(); ++i){
+    ContentionSnapshot s = sites[i]->snapshot();
+
+    out << (i ? "," : "") << "{\"name\":\"" << s.name << "\",\"acquisitions\":" << s.acquisitions
+        << ",\"contended\":" << s.contended << ",\"waits\":" << s.waits << ",\"wakeups\":" << s.wakeups
+        << ",\"spurious\":" << s.spurious << ",\"per_thread\":[";
+    for(size_t t = 0; t < s.per_thread.size(); ++t)
+      out << (t ? "," : "") << s.per_thread[t];
+    out << "],\"lock_wait\":";
+    dump_histogram(out, s.lock_wait);
+    out << ",\"cv_wait\":";
+    dump_histogram(out, s.cv_wait);
+    out << ",\"hold\":";
+    dump_histogram(out, s.hold);
+    out << "}";
+  }
+  out << "]}\n";
+}
+
+// set from the signal handler, polled by the dump thread; a lock-free atomic
+// rather than volatile sig_atomic_t, as the handler and the poller are on
+// different threads
+std::atomic<bool> contention_dump_requested(false);
+
+void request_contention_dump(int){
+  contention_dump_requested.store(true, std::memory_order_relaxed);
+}
+
+// Dumps to stderr whenever sig (e.g. SIGUSR1) arrives, while it is alive. The
+// handler only sets a flag, a thread polls it and does the printing. Keep it
+// in main so the thread is joined before any static site is destroyed.
+class ContentionDumper {
+  public:
+    // constructor, installs the handler and starts the thread
+    explicit ContentionDumper(int);
+
+    // destructor, stops the thread and puts the previous handler back
+    ~ContentionDumper();
+
+  private:
+    int sig;
+    void (*previous)(int);
+    bool stop;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread poller;
+
+    ContentionDumper(const ContentionDumper&);
+    ContentionDumper& operator=(const ContentionDumper&);
+};
+
+ContentionDumper::ContentionDumper(int sig) : sig(sig), stop(false) {
+  previous = std::signal(sig, request_contention_dump);
+
+  poller = std::thread([this](){
+    std::unique_lock<std::mutex> lck(mtx);
+
+    while(!cv.wait_for(lck, std::chrono::milliseconds(100), [this](){ return stop; }))
+      if(contention_dump_requested.exchange(false, std::memory_order_relaxed))
+        dump_contention(std::cerr);
+  });
+}
+
+ContentionDumper::~ContentionDumper(){
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+    stop = true;
+  }
+  cv.notify_one();
+  poller.join();
+  std::signal(sig, previous);
+}
+
+#endif
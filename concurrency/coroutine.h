@@ -0,0 +1,337 @@
+// coroutine.h
+// author:  Joseph Perry
+// desc:    This file defines a single-threaded event loop for running agents
+//          as C++20 coroutines. An agent suspends instead of blocking a
+//          thread:
+//
+//            co_await loop.sleep_for(d)     - resumes after d, via a timer wheel
+//            co_await loop.yield()          - lets every other ready agent run first
+//            co_await list.wait()           - resumes when someone calls
+//                                             list.wake_one() or wake_all()
+//
+//          An agent costs one coroutine frame, typically a couple of hundred bytes,
+//          so hundreds of thousands fit in one process. Everything runs on the
+//          thread that calls run(), so agents share state without locks.
+//          Requires C++20.
+
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <thread>
+#include <coroutine>
+#include <exception>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+
+class EventLoop;
+
+// A spawned coroutine. The frame destroys itself when the body returns, and
+// the loop counts it as finished.
+class CoroAgent {
+  public:
+    struct promise_type {
+      EventLoop *loop = nullptr;
+      std::coroutine_handle<promise_type> next_waiter = nullptr;   // link in a WaitList
+
+      CoroAgent get_return_object(){ return CoroAgent(std::coroutine_handle<promise_type>::from_promise(*this)); }
+      std::suspend_always initial_suspend() noexcept { return {}; }   // runs once spawned
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void();
+      void unhandled_exception(){ std::terminate(); }
+
+      // frames are counted so the memory per agent can be reported
+      static void* operator new(size_t);
+      static void operator delete(void*, size_t);
+    };
+
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    // destructor, destroys the coroutine if it was never spawned
+    ~CoroAgent(){ if(handle) handle.destroy(); }
+
+    CoroAgent(CoroAgent &&other) : handle(other.handle) { other.handle = nullptr; }
+
+    // getters for the bytes and number of frames currently allocated, over every agent
+    static size_t inline frame_bytes(){ return bytes; }
+    static size_t inline frames(){ return count; }
+
+  private:
+    Handle handle;
+
+    static size_t bytes;
+    static size_t count;
+
+    explicit CoroAgent(Handle handle) : handle(handle) {}
+    CoroAgent(const CoroAgent&);
+    CoroAgent& operator=(const CoroAgent&);
+
+    friend class EventLoop;
+};
+
+size_t CoroAgent::bytes = 0;
+size_t CoroAgent::count = 0;
+
+void* CoroAgent::promise_type::operator new(size_t size){
+  bytes += size;
+  ++count;
+  return ::operator new(size);
+}
+
+void CoroAgent::promise_type::operator delete(void *frame, size_t size){
+  bytes -= size;
+  --count;
+  ::operator delete(frame);
+}
+
+// Hashed timer wheel. A deadline is rounded up to a whole tick and stored in
+// slot tick % slots; expiring walks only the slots whose ticks have passed.
+class TimerWheel {
+  public:
+    // constructor, resolution and number of slots
+    TimerWheel(std::chrono::nanoseconds, int = 4096);
+
+    // resume h at or after deadline
+    void add(std::chrono::steady_clock::time_point, std::coroutine_handle<>);
+
+    // move every timer due by now to ready
+    void expire(std::chrono::steady_clock::time_point, std::deque<std::coroutine_handle<>>&);
+
+    // earliest deadline, only meaningful if not empty
+    std::chrono::steady_clock::time_point next_deadline();
+
+    bool inline empty(){ return pending == 0; }
+    size_t inline size(){ return pending; }
+
+  private:
+    struct Entry {
+      uint64_t tick;
+      std::coroutine_handle<> handle;
+    };
+
+    std::chrono::nanoseconds tick;
+    std::chrono::steady_clock::time_point origin;
+    std::vector<std::vector<Entry>> slots;
+    uint64_t cursor;                          // first tick not yet expired
+    size_t pending;
+
+    uint64_t ticks_until(std::chrono::steady_clock::time_point);
+};
+
+// constructor
+TimerWheel::TimerWheel(std::chrono::nanoseconds tick, int num_slots)
+  : tick(tick), origin(std::chrono::steady_clock::now()), slots(num_slots), cursor(0), pending(0) {}
+
+uint64_t TimerWheel::ticks_until(std::chrono::steady_clock::time_point t){
+  if(t <= origin)
+    return 0;
+  return (t - origin).count() / tick.count();
+}
+
+// rounded up so a timer never fires early
+void TimerWheel::add(std::chrono::steady_clock::time_point deadline, std::coroutine_handle<> h){
+  uint64_t t = ticks_until(deadline);
+
+  if(origin + t * tick < deadline)
+    ++t;
+  if(t < cursor)
+    t = cursor;
+
+  slots[t % slots.size()].push_back(Entry{ t, h });
+  ++pending;
+}
+
+// every pending entry has tick >= cursor, so the due ones all live in the
+// slots for ticks [cursor, now], or in every slot once a whole turn has passed
+void TimerWheel::expire(std::chrono::steady_clock::time_point now, std::deque<std::coroutine_handle<>> &ready){
+  uint64_t now_tick = ticks_until(now);
+  uint64_t steps;
+
+  if(now_tick < cursor)
+    return;
+
+  steps = std::min<uint64_t>(now_tick - cursor + 1, slots.size());
+  for(uint64_t i = 0; i < steps && pending > 0; ++i){
+    std::vector<Entry> &slot = slots[(cursor + i) % slots.size()];
+
+    for(size_t j = 0; j < slot.size(); ){
+      if(slot[j].tick <= now_tick){
+        ready.push_back(slot[j].handle);
+        slot[j] = slot.back();
+        slot.pop_back();
+        --pending;
+      } else {
+        ++j;
+      }
+    }
+  }
+
+  cursor = now_tick + 1;
+}
+
+// looks one turn of the wheel ahead, then falls back to scanning every entry
+std::chrono::steady_clock::time_point TimerWheel::next_deadline(){
+  uint64_t best = UINT64_MAX;
+
+  for(uint64_t i = 0; i < slots.size(); ++i)
+    for(const Entry &e : slots[(cursor + i) % slots.size()])
+      if(e.tick == cursor + i)
+        return origin + e.tick * tick;
+
+  for(const std::vector<Entry> &slot : slots)
+    for(const Entry &e : slot)
+      best = std::min(best, e.tick);
+
+  return origin + best * tick;
+}
+
+class EventLoop {
+  public:
+    // constructor, the timer resolution
+    explicit EventLoop(std::chrono::nanoseconds = std::chrono::microseconds(100));
+
+    // take ownership of an agent and make it ready
+    void spawn(CoroAgent);
+
+    // run until every agent has finished, or every remaining agent waits on
+    // a list nobody will wake; returns the number of agents left waiting
+    long run();
+
+    // awaitable that resumes after d, zero only yields
+    struct SleepAwaiter {
+      EventLoop &loop;
+      std::chrono::nanoseconds d;
+
+      bool await_ready(){ return false; }
+      void await_suspend(std::coroutine_handle<> h){ loop.schedule(h, d); }
+      void await_resume(){}
+    };
+    SleepAwaiter inline sleep_for(std::chrono::nanoseconds d){ return SleepAwaiter{ *this, d }; }
+    SleepAwaiter inline yield(){ return SleepAwaiter{ *this, std::chrono::nanoseconds(0) }; }
+
+    // make a suspended agent ready
+    void inline ready(std::coroutine_handle<> h){ queue.push_back(h); }
+
+    // getters
+    long inline agents(){ return live; }
+    uint64_t inline resumes(){ return num_resumes; }
+
+  private:
+    static const int CLOCK_EVERY = 256;      // resumes between timer checks while busy
+
+    std::deque<std::coroutine_handle<>> queue;
+    TimerWheel timers;
+    long live;
+    uint64_t num_resumes;
+
+    void schedule(std::coroutine_handle<>, std::chrono::nanoseconds);
+
+    friend struct CoroAgent::promise_type;
+};
+
+void CoroAgent::promise_type::return_void(){
+  --loop->live;
+}
+
+// constructor
+EventLoop::EventLoop(std::chrono::nanoseconds tick) : timers(tick), live(0), num_resumes(0) {}
+
+void EventLoop::spawn(CoroAgent agent){
+  agent.handle.promise().loop = this;
+  ++live;
+  queue.push_back(agent.handle);
+  agent.handle = nullptr;
+}
+
+void EventLoop::schedule(std::coroutine_handle<> h, std::chrono::nanoseconds d){
+  if(d.count() <= 0)
+    queue.push_back(h);
+  else
+    timers.add(std::chrono::steady_clock::now() + d, h);
+}
+
+long EventLoop::run(){
+  while(live > 0){
+    if(!queue.empty()){
+      std::coroutine_handle<> h = queue.front();
+      queue.pop_front();
+      h.resume();
+
+      if(++num_resumes % CLOCK_EVERY == 0 && !timers.empty())
+        timers.expire(std::chrono::steady_clock::now(), queue);
+      continue;
+    }
+
+    // nothing ready and nothing will become ready
+    if(timers.empty())
+      break;
+
+    std::this_thread::sleep_until(timers.next_deadline());
+    timers.expire(std::chrono::steady_clock::now(), queue);
+  }
+
+  return live;
+}
+
+// Agents waiting for a condition, woken in arrival order. The condition is
+// the caller's to check, as with a condition variable. The queue is linked
+// through the waiting agents' promises, so an empty list allocates nothing.
+class WaitList {
+  public:
+    WaitList() : head(nullptr), tail(nullptr) {}
+
+    struct WaitAwaiter {
+      WaitList &list;
+
+      bool await_ready(){ return false; }
+      void await_suspend(CoroAgent::Handle h){ list.push(h); }
+      void await_resume(){}
+    };
+
+    // awaitable that suspends until woken
+    WaitAwaiter inline wait(){ return WaitAwaiter{ *this }; }
+
+    // make the agent waiting longest ready, false if nobody waits
+    bool wake_one();
+
+    // make every waiting agent ready
+    void wake_all();
+
+    bool inline empty(){ return !head; }
+
+  private:
+    CoroAgent::Handle head, tail;
+
+    void push(CoroAgent::Handle);
+};
+
+void WaitList::push(CoroAgent::Handle h){
+  h.promise().next_waiter = nullptr;
+  if(tail)
+    tail.promise().next_waiter = h;
+  else
+    head = h;
+  tail = h;
+}
+
+bool WaitList::wake_one(){
+  if(!head)
+    return false;
+
+  CoroAgent::Handle h = head;
+  head = h.promise().next_waiter;
+  if(!head)
+    tail = nullptr;
+  h.promise().loop->ready(h);
+  return true;
+}
+
+void WaitList::wake_all(){
+  while(wake_one());
+}
+
+#endif
@@ -0,0 +1,370 @@
+// event_log.h
+// author:  Joseph Perry
+// desc:    This file defines an asynchronous event log for the hot paths of the
+//          concurrency simulations. Appending an event stores a timestamp, a
+//          static message and two numbers in the calling thread's own ring
+//          buffer: no lock, no allocation and no I/O, so it can be done inside
+//          a critical section. A background thread drains every buffer, orders
+//          each batch by time and writes it as text or as a binary trace.
+//
+//          A full buffer drops the event rather than wait; the number dropped
+//          is reported when the log is destroyed. Buffers of threads that have
+//          exited are reused by new threads once drained.
+//
+//          log_event() writes to the installed log, or to a text log on
+//          std::cout created on first use.
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+enum class Log_format : int { Text, Binary };
+
+// one logged event, the message must be a string literal or otherwise outlive the log
+struct Event {
+  uint64_t ns;                          // since the log was created
+  const char *message;
+  int32_t agent;                        // printed before the message, -1 for none
+  int64_t value;                        // printed after the message
+};
+
+class EventLog {
+  public:
+    // constructor, starts the thread writing to out; capacity is events per thread, rounded up to a power of two
+    EventLog(std::ostream&, Log_format = Log_format::Text, size_t = 8192);
+
+    // destructor, writes everything still buffered and stops the thread
+    ~EventLog();
+
+    // append an event from the calling thread, never blocks
+    void log(const char*, int, long);
+
+    // write everything appended so far, by any thread
+    void flush();
+
+    // getter for the number of events lost to full buffers
+    uint64_t inline dropped(){ return num_dropped.load(std::memory_order_relaxed); }
+
+    // make this the log used by log_event(), returns the previous one
+    static EventLog* install(EventLog*);
+
+    // the installed log, or the default text log on std::cout
+    static EventLog& current();
+
+  private:
+    enum class Buffer_state : int { Owned, Orphaned, Free };
+
+    // single producer, single consumer ring
+    struct Buffer {
+      std::vector<Event> events;
+      std::atomic<uint64_t> head;         // next slot the owner writes
+      std::atomic<uint64_t> tail;         // next slot the drain reads
+      std::atomic<Buffer_state> state;
+
+      Buffer(size_t capacity) : events(capacity), head(0), tail(0), state(Buffer_state::Owned) {}
+    };
+
+    // held by each thread, marks its buffers orphaned when the thread exits
+    struct Lease {
+      std::vector<std::pair<uint64_t, std::shared_ptr<Buffer>>> buffers;   // by log serial
+
+      ~Lease(){
+        for(auto &b : buffers)
+          b.second->state.store(Buffer_state::Orphaned, std::memory_order_release);
+      }
+    };
+
+    std::ostream &out;
+    Log_format format;
+    size_t capacity;
+    uint64_t serial;                      // tells logs apart even if one reuses another's address
+    std::chrono::steady_clock::time_point origin;
+    std::atomic<uint64_t> num_dropped;
+    std::atomic<bool> stopping;
+
+    std::mutex buffers_mtx;               // taken once per thread, to register a buffer
+    std::vector<std::shared_ptr<Buffer>> buffers;
+
+    std::mutex drain_mtx;                 // one consumer at a time
+    std::vector<Event> batch;
+    std::map<const char*, uint32_t> strings;   // binary trace string table
+    std::thread drainer;
+
+    static std::atomic<uint64_t> next_serial;
+    static std::atomic<EventLog*> installed;
+
+    Buffer& local();
+    size_t drain();                       // caller holds drain_mtx
+    void write(const Event&);
+    void run();
+};
+
+// [seconds] <agent><message><value>, shared by the text log and the trace decoder
+void print_event(std::ostream &out, uint64_t ns, int32_t agent, const char *message, int64_t value){
+  out << "[" << std::fixed << std::setprecision(6) << ns / 1e9 << "] ";
+  if(agent >= 0)
+    out << agent;
+  out << message << value << "\n";
+}
+
+std::atomic<uint64_t> EventLog::next_serial(0);
+std::atomic<EventLog*> EventLog::installed(nullptr);
+
+// constructor
+EventLog::EventLog(std::ostream &out, Log_format format, size_t capacity)
+  : out(out), format(format), capacity(1), serial(next_serial.fetch_add(1)),
+    origin(std::chrono::steady_clock::now()), num_dropped(0), stopping(false) {
+  while(this->capacity < capacity)
+    this->capacity *= 2;
+
+  if(format == Log_format::Binary)
+    out.write("EVLOG1\n", 7);
+
+  drainer = std::thread([this](){ run(); });
+}
+
+// destructor
+EventLog::~EventLog(){
+  EventLog *self = this;
+
+  installed.compare_exchange_strong(self, nullptr);
+
+  stopping.store(true);
+  drainer.join();
+  flush();
+
+  if(num_dropped.load() > 0)
+    std::cerr << "event log: " << num_dropped.load() << " events dropped\n";
+}
+
+// reuse a drained buffer of an exited thread before allocating a new one
+EventLog::Buffer& EventLog::local(){
+  thread_local Lease lease;
+
+  for(auto &b : lease.buffers)
+    if(b.first == serial)
+      return *b.second;
+
+  std::shared_ptr<Buffer> buffer;
+  {
+    std::lock_guard<std::mutex> lck(buffers_mtx);
+
+    for(std::shared_ptr<Buffer> &b : buffers){
+      Buffer_state free_state = Buffer_state::Free;
+      if(b->state.compare_exchange_strong(free_state, Buffer_state::Owned)){
+        buffer = b;
+        break;
+      }
+    }
+
+    if(!buffer){
+      buffer = std::make_shared<Buffer>(capacity);
+      buffers.push_back(buffer);
+    }
+  }
+
+  lease.buffers.push_back(std::make_pair(serial, buffer));
+  return *buffer;
+}
+
+void EventLog::log(const char *message, int agent, long value){
+  Buffer &b = local();
+  uint64_t head = b.head.load(std::memory_order_relaxed);
+
+  if(head - b.tail.load(std::memory_order_acquire) >= b.events.size()){
+    num_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  Event &e = b.events[head & (b.events.size() - 1)];
+  e.ns = (std::chrono::steady_clock::now() - origin).count();
+  e.message = message;
+  e.agent = agent;
+  e.value = value;
+  b.head.store(head + 1, std::memory_order_release);
+}
+
+// takes every buffered event, orders them by time and writes them
+size_t EventLog::drain(){
+  std::vector<std::shared_ptr<Buffer>> snapshot;
+
+  {
+    std::lock_guard<std::mutex> lck(buffers_mtx);
+    snapshot = buffers;
+  }
+
+  batch.clear();
+  for(std::shared_ptr<Buffer> &b : snapshot){
+    uint64_t tail = b->tail.load(std::memory_order_relaxed);
+    uint64_t head = b->head.load(std::memory_order_acquire);
+
+    for(; tail != head; ++tail)
+      batch.push_back(b->events[tail & (b->events.size() - 1)]);
+    b->tail.store(tail, std::memory_order_release);
+
+    // the owner is gone and everything it wrote is out, another thread may have it
+    Buffer_state orphaned = Buffer_state::Orphaned;
+    if(b->head.load(std::memory_order_acquire) == tail)
+      b->state.compare_exchange_strong(orphaned, Buffer_state::Free);
+  }
+
+  std::stable_sort(batch.begin(), batch.end(), [](const Event &a, const Event &b){ return a.ns < b.ns; });
+  for(const Event &e : batch)
+    write(e);
+
+  return batch.size();
+}
+
+// binary: 'S' u32 id, u32 length, bytes    the first time a message is seen
+//         'E' u64 ns, u32 id, i32 agent, i64 value
+void EventLog::write(const Event &e){
+  if(format == Log_format::Text){
+    print_event(out, e.ns, e.agent, e.message, e.value);
+    return;
+  }
+
+  auto it = strings.find(e.message);
+  uint32_t id;
+
+  if(it == strings.end()){
+    uint32_t length = static_cast<uint32_t>(std::strlen(e.message));
+
+    id = static_cast<uint32_t>(strings.size());
+    strings[e.message] = id;
+    out.put('S');
+    out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(e.message, length);
+  } else {
+    id = it->second;
+  }
+
+  out.put('E');
+  out.write(reinterpret_cast<const char*>(&e.ns), sizeof(e.ns));
+  out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+  out.write(reinterpret_cast<const char*>(&e.agent), sizeof(e.agent));
+  out.write(reinterpret_cast<const char*>(&e.value), sizeof(e.value));
+}
+
+void EventLog::flush(){
+  std::lock_guard<std::mutex> lck(drain_mtx);
+
+  drain();
+  out.flush();
+}
+
+// polls every millisecond while idle, output is flushed once the buffers run dry
+void EventLog::run(){
+  while(!stopping.load()){
+    size_t n;
+
+    {
+      std::lock_guard<std::mutex> lck(drain_mtx);
+      n = drain();
+      if(n == 0)
+        out.flush();
+    }
+
+    if(n == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+EventLog* EventLog::install(EventLog *log){
+  return installed.exchange(log);
+}
+
+EventLog& EventLog::current(){
+  EventLog *log = installed.load(std::memory_order_acquire);
+
+  if(log != nullptr)
+    return *log;
+
+  static EventLog console(std::cout);
+  return console;
+}
+
+// append an event to the current log
+inline void log_event(const char *message, int agent, long value){
+  EventLog::current().log(message, agent, value);
+}
+
+// write everything logged so far, e.g. before printing a report
+inline void flush_events(){
+  EventLog::current().flush();
+}
+
+// A binary trace file, installed as the current log for as long as it lives
+class EventTrace {
+  public:
+    // constructor, check is_open() before relying on it
+    explicit EventTrace(const std::string&);
+
+    bool inline is_open(){ return file.is_open(); }
+
+  private:
+    std::ofstream file;
+    std::unique_ptr<EventLog> log;            // declared after file, so destroyed before it
+};
+
+// constructor
+EventTrace::EventTrace(const std::string &path) : file(path, std::ios::binary) {
+  if(!file)
+    return;
+
+  log.reset(new EventLog(file, Log_format::Binary));
+  EventLog::install(log.get());
+}
+
+// converts a binary trace back to the text format, false if it is malformed
+bool decode_event_trace(std::istream &in, std::ostream &out){
+  std::vector<std::string> strings;
+  char magic[7];
+  char kind;
+
+  if(!in.read(magic, 7) || std::string(magic, 7) != "EVLOG1\n")
+    return false;
+
+  while(in.get(kind)){
+    if(kind == 'S'){
+      uint32_t id, length;
+
+      if(!in.read(reinterpret_cast<char*>(&id), sizeof(id)) || !in.read(reinterpret_cast<char*>(&length), sizeof(length)))
+        return false;
+      std::string message(length, '\0');
+      if(!in.read(&message[0], length) || id != strings.size())
+        return false;
+      strings.push_back(message);
+    } else if(kind == 'E'){
+      Event e;
+      uint32_t id;
+
+      if(!in.read(reinterpret_cast<char*>(&e.ns), sizeof(e.ns)) || !in.read(reinterpret_cast<char*>(&id), sizeof(id))
+         || !in.read(reinterpret_cast<char*>(&e.agent), sizeof(e.agent)) || !in.read(reinterpret_cast<char*>(&e.value), sizeof(e.value))
+         || id >= strings.size())
+        return false;
+
+      print_event(out, e.ns, e.agent, strings[id].c_str(), e.value);
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+#endif
@@ -0,0 +1,122 @@
+// run_config.h
+// author:  Joseph Perry
+// desc:    This file defines the command line options shared by the concurrency
+//          simulations (smoker, dining philosophers): how long to run, how long
+//          agents work and think, and the seed for any random choices, and
+//          opens the event trace they ask for.
+
+#ifndef RUN_CONFIG_H
+#define RUN_CONFIG_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include "event_log.h"
+
+struct RunConfig {
+  long rounds;                          // stop after this many rounds, 0 is unbounded
+  std::chrono::nanoseconds duration;    // stop after this much time, 0 is unbounded
+  std::chrono::nanoseconds think;       // pause between rounds, outside any resource
+  std::chrono::nanoseconds work;        // time spent holding the acquired resources
+  unsigned seed;                        // seed for every random choice
+  bool verbose;                         // log every event, always on with a trace
+  bool contention;                      // instrument the lock sites, see contention.h
+  std::string trace;                    // write events as a binary trace to this file, see event_log.h
+
+  RunConfig() : rounds(0), duration(0), think(std::chrono::seconds(1)), work(0), seed(1), verbose(true), contention(false) {}
+
+  // true if the run ends by itself and should report metrics
+  bool inline bounded() const { return rounds > 0 || duration.count() > 0; }
+};
+
+// sleeps for d unless it is zero, so zero think/work times cost nothing
+inline void pause_for(std::chrono::nanoseconds d){
+  if(d.count() > 0)
+    std::this_thread::sleep_for(d);
+}
+
+void print_run_usage(const char *program){
+  std::cerr << "Usage: " << program << " [--rounds N] [--seconds S] [--think-ms T] [--work-ms W] [--seed N] [--quiet] [--contention] [--trace FILE]\n";
+}
+
+// converts a number of milliseconds, which may be fractional, to nanoseconds
+std::chrono::nanoseconds milliseconds_to_ns(double ms){
+  return std::chrono::nanoseconds(static_cast<long long>(ms * 1e6));
+}
+
+// parses argv[first..argc) into config, leaving unspecified fields untouched.
+// returns false after printing usage if an option is unknown or malformed
+bool parse_run_config(int argc, char *argv[], RunConfig &config, int first = 1){
+  for(int i = first; i < argc; ++i){
+    std::string option = argv[i];
+    double value;
+
+    if(option == "--quiet"){
+      config.verbose = false;
+      continue;
+    }
+
+    if(option == "--contention"){
+      config.contention = true;
+      continue;
+    }
+
+    if(i + 1 >= argc){
+      std::cerr << "Missing value for " << option << "\n";
+      print_run_usage(argv[0]);
+      return false;
+    }
+
+    if(option == "--trace"){
+      config.trace = argv[++i];
+      continue;
+    }
+
+    std::istringstream ss(argv[++i]);
+    if(!(ss >> value) || value < 0){
+      std::cerr << "Invalid input : " << argv[i] << " (expected a non-negative number for " << option << ")\n";
+      print_run_usage(argv[0]);
+      return false;
+    }
+
+    if(option == "--rounds")
+      config.rounds = static_cast<long>(value);
+    else if(option == "--seconds")
+      config.duration = milliseconds_to_ns(value * 1000);
+    else if(option == "--think-ms")
+      config.think = milliseconds_to_ns(value);
+    else if(option == "--work-ms")
+      config.work = milliseconds_to_ns(value);
+    else if(option == "--seed")
+      config.seed = static_cast<unsigned>(value);
+    else {
+      std::cerr << "Unknown option : " << option << "\n";
+      print_run_usage(argv[0]);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// installs the binary trace config.trace names, if any, in trace; events are
+// then always logged, to the file, whatever --quiet says. false after
+// printing an error if the file cannot be opened
+bool open_event_trace(RunConfig &config, std::unique_ptr<EventTrace> &trace){
+  if(config.trace.empty())
+    return true;
+
+  trace.reset(new EventTrace(config.trace));
+  if(!trace->is_open()){
+    std::cerr << "Cannot open trace : " << config.trace << "\n";
+    return false;
+  }
+
+  config.verbose = true;
+  return true;
+}
+
+#endif
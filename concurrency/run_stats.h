@@ -0,0 +1,154 @@
+// run_stats.h
+// author:  Joseph Perry
+// desc:    This file defines a log-scale latency histogram and the end-of-run
+//          report shared by the concurrency simulations: throughput, per-agent
+//          counts, fairness and wait-latency distribution.
+
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+// Histogram of durations, bucket i holds samples in [2^i, 2^(i+1)) nanoseconds.
+// Not thread-safe, each agent owns one and they are merged after the run.
+class LatencyHistogram {
+  public:
+    static const int BUCKETS = 64;
+
+    LatencyHistogram() : buckets(BUCKETS, 0), count(0), sum(0), max(0) {}
+
+    // rebuild a histogram from its raw buckets, sum and max
+    LatencyHistogram(const std::vector<uint64_t>&, uint64_t, uint64_t);
+
+    // index of the bucket holding a sample of ns nanoseconds
+    static int bucket(uint64_t);
+
+    // add one sample
+    void record(std::chrono::nanoseconds);
+
+    // add every sample of other
+    void merge(const LatencyHistogram&);
+
+    // upper bound of the bucket holding the p-th percentile, p in [0, 100]
+    uint64_t percentile(double) const;
+
+    // prints summary statistics and every non-empty bucket
+    void print(std::ostream&) const;
+
+    // getters
+    uint64_t inline samples() const { return count; }
+    double inline mean() const { return count ? (double)sum / count : 0; }
+    uint64_t inline maximum() const { return max; }
+
+  private:
+    std::vector<uint64_t> buckets;
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+};
+
+LatencyHistogram::LatencyHistogram(const std::vector<uint64_t> &raw, uint64_t sum, uint64_t max)
+  : buckets(raw), count(0), sum(sum), max(max) {
+  buckets.resize(BUCKETS, 0);
+  for(uint64_t b : buckets)
+    count += b;
+}
+
+int LatencyHistogram::bucket(uint64_t ns){
+  int b = 0;
+
+  while((ns >> (b + 1)) != 0 && b < BUCKETS - 1)
+    ++b;
+
+  return b;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds d){
+  uint64_t ns = d.count() > 0 ? d.count() : 0;
+
+  ++buckets[bucket(ns)];
+  ++count;
+  sum += ns;
+  if(ns > max)
+    max = ns;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other){
+  for(int i = 0; i < BUCKETS; ++i)
+    buckets[i] += other.buckets[i];
+  count += other.count;
+  sum += other.sum;
+  if(other.max > max)
+    max = other.max;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+  uint64_t target = static_cast<uint64_t>(p / 100.0 * count);
+  uint64_t seen = 0;
+
+  for(int i = 0; i < BUCKETS; ++i){
+    seen += buckets[i];
+    if(seen > target || (seen == count && seen > 0))
+      return std::min<uint64_t>(max, (2ull << i) - 1);
+  }
+
+  return max;
+}
+
+void LatencyHistogram::print(std::ostream &out) const {
+  out << "  samples " << count << ", mean " << std::fixed << std::setprecision(0) << mean()
+      << " ns, p50 <= " << percentile(50) << " ns, p99 <= " << percentile(99)
+      << " ns, max " << max << " ns\n";
+
+  for(int i = 0; i < BUCKETS; ++i)
+    if(buckets[i] > 0)
+      out << "  [" << std::setw(12) << (i == 0 ? 0 : 1ull << i) << ", " << std::setw(12) << (2ull << i)
+          << ") ns " << std::setw(10) << buckets[i] << "\n";
+}
+
+// prints throughput, per-agent counts (or their spread for many agents),
+// fairness (min/max count) and the merged wait-latency histogram of every agent
+void print_run_report(std::ostream &out, const std::string &name, std::chrono::steady_clock::duration elapsed,
+                      const std::vector<long> &counts, const std::vector<LatencyHistogram> &waits){
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  long total = 0, lo = 0, hi = 0;
+  LatencyHistogram all;
+
+  for(size_t i = 0; i < counts.size(); ++i){
+    total += counts[i];
+    lo = (i == 0) ? counts[i] : std::min(lo, counts[i]);
+    hi = (i == 0) ? counts[i] : std::max(hi, counts[i]);
+  }
+  for(const LatencyHistogram &h : waits)
+    all.merge(h);
+
+  out << name << ": " << total << " in " << std::fixed << std::setprecision(3) << seconds << " s, "
+      << std::setprecision(0) << (seconds > 0 ? total / seconds : 0) << "/sec\n";
+
+  // past a screenful of agents only the spread is printed
+  if(counts.size() <= 32){
+    out << "per agent:";
+    for(long c : counts)
+      out << " " << c;
+    out << "\n";
+  } else {
+    std::vector<long> sorted(counts);
+
+    std::sort(sorted.begin(), sorted.end());
+    out << "per agent (" << sorted.size() << "): min " << sorted.front() << ", median "
+        << sorted[sorted.size() / 2] << ", max " << sorted.back() << "\n";
+  }
+
+  out << "fairness (min/max): " << std::setprecision(3) << (hi > 0 ? (double)lo / hi : 0) << "\n";
+
+  out << "wait latency:\n";
+  all.print(out);
+}
+
+#endif
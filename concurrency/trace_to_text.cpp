@@ -0,0 +1,27 @@
+// trace_to_text.cpp
+// author:  Joseph Perry
+// desc:    Prints a binary event trace (see event_log.h, --trace) as text.
+//
+//          usage: ./trace_to_text trace_file
+
+#include "event_log.h"
+
+int main(int argc, char *argv[]){
+  if(argc != 2){
+    std::cerr << "Usage: " << argv[0] << " trace_file\n";
+    return 1;
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if(!in){
+    std::cerr << "Cannot open trace : " << argv[1] << "\n";
+    return 1;
+  }
+
+  if(!decode_event_trace(in, std::cout)){
+    std::cerr << "Malformed trace : " << argv[1] << "\n";
+    return 1;
+  }
+
+  return 0;
+}
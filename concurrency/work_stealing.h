@@ -0,0 +1,293 @@
+// work_stealing.h
+// author:  Joseph Perry
+// desc:    This file defines a work-stealing pool that runs many agents as
+//          resumable tasks on a few worker threads, instead of one thread per
+//          agent. A task runs one step at a time and says what happens next:
+//
+//            Yield   - put it back in the queue, it has more to do
+//            Parked  - it is waiting for something; whoever makes progress
+//                      possible calls resume() on it, so nothing polls
+//            Done    - it is finished
+//
+//          Every worker has its own deque. A worker runs its own tasks oldest
+//          first, and when it runs out it steals half of another worker's
+//          queue from the newest end. Idle workers sleep until work is queued.
+//
+//          A task that parks makes itself visible to whoever will resume it
+//          (usually by adding itself to a wait list under a lock) and must not
+//          touch its own state after that, since another worker may already be
+//          running it.
+
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include "contention.h"
+
+enum class Task_state : int { Yield, Parked, Done };
+
+class WorkStealingPool;
+
+class Task {
+  public:
+    virtual ~Task() {}
+
+    // run one step
+    virtual Task_state run(WorkStealingPool&) = 0;
+};
+
+class WorkStealingPool {
+  public:
+    // constructor, 0 workers is one per hardware thread
+    explicit WorkStealingPool(int = 0);
+
+    // destructor, stops the workers; tasks still queued are dropped, call wait() first
+    ~WorkStealingPool();
+
+    // queue a new task, the caller keeps ownership
+    void spawn(Task*);
+
+    // queue a task that had parked
+    void resume(Task*);
+
+    // block until every spawned task is done
+    void wait();
+
+    // getter for the number of workers
+    int inline workers(){ return static_cast<int>(queues.size()); }
+
+    // totals over every worker, readable while running
+    struct Stats {
+      uint64_t steps;       // calls to Task::run
+      uint64_t steals;      // successful steal attempts
+      uint64_t stolen;      // tasks moved by them
+      uint64_t parks;
+      uint64_t sleeps;      // times a worker went idle
+    };
+    Stats stats();
+
+    void print_stats(std::ostream&);
+
+  private:
+    // padded to a cache line so workers do not false-share
+    struct alignas(64) Worker {
+      std::mutex mtx;
+      std::deque<Task*> tasks;
+      std::atomic<uint64_t> steps, steals, stolen, parks, sleeps;
+
+      Worker() : steps(0), steals(0), stolen(0), parks(0), sleeps(0) {}
+    };
+
+    static const int SPINS = 64;
+
+    std::vector<Worker> queues;
+    std::vector<std::thread> threads;
+    std::atomic<long> live;               // spawned and not done
+    std::atomic<long> queued;             // sitting in some deque
+    std::atomic<int> sleeping;
+    std::atomic<bool> stopping;
+    std::atomic<unsigned> next_queue;     // round robin for pushes from outside the pool
+    std::mutex idle_mtx;
+    std::condition_variable idle_cv;
+    std::mutex done_mtx;
+    std::condition_variable done_cv;
+
+    void push(Task*);
+    Task* pop(int);
+    bool steal(int);
+    bool idle(int);                       // false once the pool is stopping
+    void work(int);
+
+    // the pool and worker index of the calling thread, if it is a worker
+    static thread_local WorkStealingPool *owner;
+    static thread_local int current;
+};
+
+thread_local WorkStealingPool *WorkStealingPool::owner = nullptr;
+thread_local int WorkStealingPool::current = -1;
+
+// constructor
+WorkStealingPool::WorkStealingPool(int num_workers)
+  : queues(num_workers > 0 ? num_workers : std::max(1u, std::thread::hardware_concurrency())),
+    live(0), queued(0), sleeping(0), stopping(false), next_queue(0) {
+  for(int i = 0; i < workers(); ++i)
+    threads.emplace_back([this, i](){ work(i); });
+}
+
+// destructor
+WorkStealingPool::~WorkStealingPool(){
+  {
+    std::lock_guard<std::mutex> lck(idle_mtx);
+    stopping.store(true);
+    idle_cv.notify_all();
+  }
+
+  for(std::thread &t : threads)
+    t.join();
+}
+
+void WorkStealingPool::spawn(Task *task){
+  live.fetch_add(1);
+  push(task);
+}
+
+void WorkStealingPool::resume(Task *task){
+  push(task);
+}
+
+// a worker pushes to its own deque, anyone else spreads tasks round robin
+void WorkStealingPool::push(Task *task){
+  int q = (owner == this) ? current : static_cast<int>(next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size());
+
+  {
+    std::lock_guard<std::mutex> lck(queues[q].mtx);
+    queues[q].tasks.push_back(task);
+  }
+
+  // pairs with the sleeping/queued check in idle(), one side always sees the other
+  queued.fetch_add(1);
+  if(sleeping.load() > 0){
+    std::lock_guard<std::mutex> lck(idle_mtx);
+    idle_cv.notify_one();
+  }
+}
+
+Task* WorkStealingPool::pop(int id){
+  std::lock_guard<std::mutex> lck(queues[id].mtx);
+  Task *task;
+
+  if(queues[id].tasks.empty())
+    return nullptr;
+
+  task = queues[id].tasks.front();
+  queues[id].tasks.pop_front();
+  queued.fetch_sub(1, std::memory_order_relaxed);
+  return task;
+}
+
+// take the newest half of the first victim that has anything, starting at a random worker
+bool WorkStealingPool::steal(int id){
+  thread_local unsigned seed = 2463534242u + id;
+  std::vector<Task*> loot;
+  int n = workers();
+
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  for(int i = 0; i < n - 1 && loot.empty(); ++i){
+    Worker &victim = queues[(id + 1 + (seed + i) % (n - 1)) % n];
+    std::lock_guard<std::mutex> lck(victim.mtx);
+    size_t take = (victim.tasks.size() + 1) / 2;
+
+    loot.assign(victim.tasks.end() - take, victim.tasks.end());
+    victim.tasks.erase(victim.tasks.end() - take, victim.tasks.end());
+  }
+
+  if(loot.empty())
+    return false;
+
+  {
+    std::lock_guard<std::mutex> lck(queues[id].mtx);
+    queues[id].tasks.insert(queues[id].tasks.end(), loot.begin(), loot.end());
+  }
+
+  bump(queues[id].steals);
+  bump(queues[id].stolen, loot.size());
+  return true;
+}
+
+// spin briefly, then sleep until something is queued
+bool WorkStealingPool::idle(int id){
+  for(int i = 0; i < SPINS; ++i){
+    if(queued.load() > 0)
+      return true;
+    if(stopping.load(std::memory_order_relaxed))
+      return false;
+    std::this_thread::yield();
+  }
+
+  std::unique_lock<std::mutex> lck(idle_mtx);
+
+  bump(queues[id].sleeps);
+  sleeping.fetch_add(1);
+  while(queued.load() == 0 && !stopping.load())
+    idle_cv.wait(lck);
+  sleeping.fetch_sub(1);
+
+  return !stopping.load();
+}
+
+void WorkStealingPool::work(int id){
+  owner = this;
+  current = id;
+
+  while(true){
+    Task *task = pop(id);
+
+    if(task == nullptr && steal(id))
+      task = pop(id);
+
+    if(task == nullptr){
+      if(!idle(id))
+        return;
+      continue;
+    }
+
+    bump(queues[id].steps);
+
+    switch(task->run(*this)){
+      case Task_state::Yield:
+        push(task);
+        break;
+
+      case Task_state::Parked:
+        bump(queues[id].parks);
+        break;
+
+      case Task_state::Done:
+        if(live.fetch_sub(1) == 1){
+          std::lock_guard<std::mutex> lck(done_mtx);
+          done_cv.notify_all();
+        }
+        break;
+    }
+  }
+}
+
+void WorkStealingPool::wait(){
+  std::unique_lock<std::mutex> lck(done_mtx);
+
+  while(live.load() > 0)
+    done_cv.wait(lck);
+}
+
+WorkStealingPool::Stats WorkStealingPool::stats(){
+  Stats s = { 0, 0, 0, 0, 0 };
+
+  for(Worker &w : queues){
+    s.steps += w.steps.load(std::memory_order_relaxed);
+    s.steals += w.steals.load(std::memory_order_relaxed);
+    s.stolen += w.stolen.load(std::memory_order_relaxed);
+    s.parks += w.parks.load(std::memory_order_relaxed);
+    s.sleeps += w.sleeps.load(std::memory_order_relaxed);
+  }
+
+  return s;
+}
+
+void WorkStealingPool::print_stats(std::ostream &out){
+  Stats s = stats();
+
+  out << "pool: " << workers() << " workers, " << s.steps << " steps, " << s.steals << " steals ("
+      << s.stolen << " tasks), " << s.parks << " parks, " << s.sleeps << " sleeps\n";
+}
+
+#endif
@@ -0,0 +1,107 @@
+// work_stealing_bench.cpp
+// author:  Joseph Perry
+// desc:    Measures the overhead of the scheduler in work_stealing.h: the cost
+//          of a task step that only yields, for few and for many tasks and for
+//          several pool sizes, and the cost of spawning and finishing a task
+//          compared with starting and joining a thread.
+//
+//          usage: ./work_stealing_bench [steps]
+
+#include "work_stealing.h"
+#include <sstream>
+#include <memory>
+#include <algorithm>
+
+// yields a fixed number of times, then finishes
+class YieldTask : public Task {
+  public:
+    YieldTask(long steps) : left(steps) {}
+
+    Task_state run(WorkStealingPool&){
+      return --left > 0 ? Task_state::Yield : Task_state::Done;
+    }
+
+  private:
+    long left;
+};
+
+// finishes on its first step
+class EmptyTask : public Task {
+  public:
+    Task_state run(WorkStealingPool&){ return Task_state::Done; }
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start){
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// steps spread over num_tasks tasks, every step goes back through the queues
+void bench_yield(int workers, long num_tasks, long steps){
+  std::vector<std::unique_ptr<YieldTask>> tasks;
+  WorkStealingPool pool(workers);
+  double seconds;
+
+  for(long i = 0; i < num_tasks; ++i)
+    tasks.emplace_back(new YieldTask(steps / num_tasks));
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(auto &t : tasks)
+    pool.spawn(t.get());
+  pool.wait();
+  seconds = seconds_since(start);
+
+  std::cout << "yield: " << workers << " workers, " << num_tasks << " tasks, "
+            << steps / seconds << " steps/sec, " << seconds * 1e9 / steps << " ns/step\n  ";
+  pool.print_stats(std::cout);
+}
+
+// a task that does nothing against a thread that does nothing
+void bench_spawn(int workers, long count){
+  std::vector<EmptyTask> tasks(count);
+  double task_seconds, thread_seconds;
+
+  {
+    WorkStealingPool pool(workers);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for(EmptyTask &t : tasks)
+      pool.spawn(&t);
+    pool.wait();
+    task_seconds = seconds_since(start);
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(long i = 0; i < count; ++i)
+    std::thread([](){}).join();
+  thread_seconds = seconds_since(start);
+
+  std::cout << "spawn: " << count << " tasks in " << task_seconds * 1e9 / count << " ns each, "
+            << "threads in " << thread_seconds * 1e9 / count << " ns each\n";
+}
+
+int main(int argc, char *argv[]){
+  long steps = 1000000;
+  int hardware = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<int> pools = { 1, 2, 4, hardware };
+
+  if(argc > 1){
+    std::istringstream ss(argv[1]);
+    if(!(ss >> steps) || steps <= 0){
+      std::cerr << "Invalid steps : " << argv[1] << "\n";
+      return 1;
+    }
+  }
+
+  std::sort(pools.begin(), pools.end());
+  pools.erase(std::unique(pools.begin(), pools.end()), pools.end());
+
+  std::cout << "hardware threads: " << hardware << "\n";
+
+  for(int workers : pools)
+    for(long num_tasks : { 1L, 1000L, 100000L })
+      bench_yield(workers, num_tasks, std::max(steps, num_tasks));
+
+  bench_spawn(hardware, std::min(steps, 100000L));
+
+  return 0;
+}
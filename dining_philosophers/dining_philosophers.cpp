@@ -0,0 +1,173 @@
+#include "dining_philosophers.h"
+#include "dining_philosophers_ordered.h"
+#include "topology.h"
+#include <fstream>
+#include <memory>
+
+using namespace std;
+
+void print_usage(const char *program){
+	cerr << "Usage: " << program << " [--philosophers N] [--topology ring|random|FILE] [--chopsticks M] [--needs K]"
+	     << " [--table single|ordered]\n";
+	print_run_usage(program);
+}
+
+// one thread per philosopher until the table closes, by itself or after the
+// duration, whichever comes first. A philosopher only leaves a closed table,
+// so the first one to leave ends the wait for the duration
+template <typename P, typename T, typename Close>
+chrono::steady_clock::duration run_table(vector<P> &philosophers, T &table, const RunConfig &config, Close close){
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<thread> threads;
+	mutex mtx;
+	condition_variable cv;
+	bool left = false;
+
+	for(size_t i = 0; i < philosophers.size(); ++i)
+		threads.emplace_back([&philosophers, &table, &mtx, &cv, &left, i](){
+			while(philosophers[i].can_eat(table));
+
+			lock_guard<mutex> lck(mtx);
+			left = true;
+			cv.notify_one();
+		});
+
+	if(config.duration.count() > 0){
+		unique_lock<mutex> lck(mtx);
+
+		if(!cv.wait_for(lck, config.duration, [&left](){ return left; })){
+			lck.unlock();
+			close();
+		}
+	}
+
+	for(thread &t : threads)
+		t.join();
+
+	return chrono::steady_clock::now() - start;
+}
+
+template <typename P>
+void report(vector<P> &philosophers, chrono::steady_clock::duration elapsed, const RunConfig &config){
+	vector<long> meals;
+	vector<LatencyHistogram> waits;
+
+	if(config.verbose)
+		flush_events();
+
+	for(P &p : philosophers){
+		meals.push_back(p.meals());
+		waits.push_back(p.waits());
+	}
+
+	print_run_report(cout, "meals", elapsed, meals, waits);
+}
+
+// Five philosophers at a ring under one mutex, running forever, by default.
+// --philosophers, --topology and --table set the size, who needs which
+// chopsticks and the arbiter: one table-wide mutex, or a mutex per chopstick
+// taken in order. With --rounds (total meals) or --seconds the table is closed
+// when the budget is spent and a report of throughput, meals per philosopher,
+// fairness and wait latency is printed. --contention adds per-site lock
+// statistics, --trace writes the events to a binary trace instead of the
+// console, with or without --quiet.
+int main(int argc, char *argv[]){
+	int num_philosophers = 5;
+	int num_chopsticks = 0;
+	int num_needs = 2;
+	string topology = "ring";
+	string table = "single";
+	vector<char*> rest(1, argv[0]);
+	RunConfig config;
+	Topology needs;
+
+	// table options first, everything else is a run option
+	for(int i = 1; i < argc; ++i){
+		string option = argv[i];
+
+		if(option == "--philosophers" || option == "--chopsticks" || option == "--needs"){
+			int value;
+
+			if(i + 1 >= argc || !(istringstream(argv[++i]) >> value) || value <= 0){
+				cerr << "Invalid input for " << option << " (expected a positive integer)\n";
+				print_usage(argv[0]);
+				return 1;
+			}
+			(option == "--philosophers" ? num_philosophers : option == "--chopsticks" ? num_chopsticks : num_needs) = value;
+		} else if(option == "--topology" || option == "--table"){
+			if(i + 1 >= argc){
+				cerr << "Missing value for " << option << "\n";
+				print_usage(argv[0]);
+				return 1;
+			}
+			(option == "--topology" ? topology : table) = argv[++i];
+		} else {
+			rest.push_back(argv[i]);
+		}
+	}
+
+	config.think = chrono::seconds(2);
+	if(!parse_run_config(static_cast<int>(rest.size()), rest.data(), config))
+		return 1;
+
+	if(topology == "ring"){
+		needs = ring_topology(num_philosophers);
+	} else if(topology == "random"){
+		num_chopsticks = num_chopsticks > 0 ? num_chopsticks : num_philosophers;
+		if(num_needs > num_chopsticks){
+			cerr << "Invalid input : " << num_needs << " chopsticks needed out of " << num_chopsticks << "\n";
+			return 1;
+		}
+		needs = random_topology(num_philosophers, num_chopsticks, num_needs, config.seed);
+	} else {
+		ifstream in(topology);
+
+		if(!in || !read_topology(in, needs) || needs.empty()){
+			cerr << "Invalid topology file : " << topology << "\n";
+			return 1;
+		}
+	}
+
+	if(table != "single" && table != "ordered"){
+		cerr << "Invalid table : " << table << "\n";
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	// events go to a binary trace instead of the console
+	std::unique_ptr<EventTrace> trace;
+	if(!open_event_trace(config, trace))
+		return 1;
+
+	// report lock contention at exit, and dump it on SIGUSR1 while running
+	std::unique_ptr<ContentionDumper> dumper;
+	if(config.contention){
+		ContentionSite::enable();
+		dumper.reset(new ContentionDumper(SIGUSR1));
+	}
+
+	if(table == "single"){
+		vector<int> chopsticks(chopstick_count(needs), 1);
+		vector<Philosopher> philosophers;
+
+		Philosopher::open(config.rounds);
+		for(size_t id = 0; id < needs.size(); ++id)
+			philosophers.emplace_back(id, needs[id], config);
+
+		report(philosophers, run_table(philosophers, chopsticks, config, [](){ Philosopher::close(); }), config);
+	} else {
+		ChopstickTable chopsticks(chopstick_count(needs));
+		vector<OrderedPhilosopher> philosophers;
+
+		chopsticks.open(config.rounds);
+		for(size_t id = 0; id < needs.size(); ++id)
+			philosophers.emplace_back(id, needs[id], config);
+
+		report(philosophers, run_table(philosophers, chopsticks, config, [&chopsticks](){ chopsticks.close(); }), config);
+	}
+
+	if(config.contention)
+		print_contention_report(cout);
+
+	return 0;
+}
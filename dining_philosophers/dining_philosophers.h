@@ -0,0 +1,158 @@
+// dining_philosophers.h
+// author:  Joseph Perry
+// desc:    This file defines a Philosopher class for the classic dining
+//          philosophers problem. The whole table is guarded by one mutex and
+//          condition variable, every meal wakes every philosopher. By default
+//          philosophers sit in a ring and share a chopstick with each
+//          neighbour, but a philosopher may need any set of chopsticks (see
+//          topology.h).
+
+#ifndef DINING_PHILOSOPHERS_H
+#define DINING_PHILOSOPHERS_H
+
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <chrono>
+#include "../concurrency/run_config.h"
+#include "../concurrency/run_stats.h"
+#include "../concurrency/contention.h"
+#include "../concurrency/event_log.h"
+
+enum class Philosopher_state : int { Dining, Thinking };
+
+class Philosopher {
+	public:
+		Philosopher(int, int, RunConfig = RunConfig());
+		Philosopher(int, std::vector<int>, RunConfig = RunConfig());
+		bool can_eat(std::vector<int> &);
+		static void close();
+		static void open(long = 0);
+		int inline meals(){ return num_dine; }
+		const LatencyHistogram& waits(){ return wait_times; }
+	private:
+		Philosopher_state state;
+		int id;
+		int num_dine;
+		std::vector<int> needs;
+		RunConfig config;
+		LatencyHistogram wait_times;
+		bool available(std::vector<int> &);
+		void get_chopsticks(std::vector<int> &);
+		void put_back_chopsticks(std::vector<int> &);
+		void eat();
+		void think();
+		static std::mutex mtx;
+		static std::condition_variable cv;
+		static bool closed;
+		static long total_meals;
+		static long meal_limit;
+		static ContentionSite site;
+};
+
+std::mutex Philosopher::mtx;
+std::condition_variable Philosopher::cv;
+bool Philosopher::closed = false;
+long Philosopher::total_meals = 0;
+long Philosopher::meal_limit = 0;
+ContentionSite Philosopher::site("philosopher table");
+
+// seated in a ring, between chopsticks id and id + 1
+Philosopher::Philosopher(int id, int num_philosophers, RunConfig config) : state(Philosopher_state::Thinking),
+										id(id),
+										num_dine(0),
+										needs({ id, (id + 1) % num_philosophers }),
+										config(config) {}
+
+// needs every chopstick in the list
+Philosopher::Philosopher(int id, std::vector<int> needs, RunConfig config) : state(Philosopher_state::Thinking),
+										id(id),
+										num_dine(0),
+										needs(needs),
+										config(config) {}
+
+// returns false once the table has been closed
+bool Philosopher::can_eat(std::vector<int> &chopsticks){
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	ContendedLock lck(mtx, site);
+
+	lck.wait(cv, [&](){ return available(chopsticks) || closed; });
+
+	if(closed)
+		return false;
+
+	wait_times.record(std::chrono::steady_clock::now() - start);
+
+	get_chopsticks(chopsticks);
+
+	eat();
+
+	// hold the chopsticks, but not the table, while eating
+	if(config.work.count() > 0){
+		lck.unlock();
+		pause_for(config.work);
+		lck.lock();
+	}
+
+	put_back_chopsticks(chopsticks);
+
+	// the meal budget is spent, everyone leaves the table
+	if(meal_limit > 0 && ++total_meals >= meal_limit)
+		closed = true;
+
+	cv.notify_all();
+
+	lck.unlock();
+	think();
+	return true;
+}
+
+// stop every philosopher after their current meal
+void Philosopher::close(){
+	std::lock_guard<std::mutex> lck(mtx);
+
+	closed = true;
+	cv.notify_all();
+}
+
+// reopen the table, closing it once this many meals have been eaten in total, 0 is unbounded
+void Philosopher::open(long limit){
+	std::lock_guard<std::mutex> lck(mtx);
+
+	closed = false;
+	total_meals = 0;
+	meal_limit = limit;
+}
+
+bool Philosopher::available(std::vector<int> &chopsticks){
+	for(int c : needs)
+		if(chopsticks[c] == 0)
+			return false;
+	return true;
+}
+
+void Philosopher::get_chopsticks(std::vector<int> &chopsticks){
+	for(int c : needs)
+		chopsticks[c] = 0;
+}
+
+void Philosopher::put_back_chopsticks(std::vector<int> &chopsticks){
+	for(int c : needs)
+		chopsticks[c] = 1;
+}
+
+void Philosopher::eat(){
+	state = Philosopher_state::Dining;
+	num_dine++;
+	if(config.verbose)
+		log_event(" eating ... ", id, num_dine);
+}
+
+void Philosopher::think(){
+	state = Philosopher_state::Thinking;
+	pause_for(config.think);
+}
+
+#endif
@@ -0,0 +1,182 @@
+// dining_philosophers_bench.cpp
+// author:  Joseph Perry
+// desc:    Measures meals/sec for the single-mutex table in dining_philosophers.h
+//          against the per-chopstick locks in dining_philosophers_ordered.h, for
+//          a growing number of philosophers, with printing and thinking
+//          disabled, and the same ordered locking run as tasks on a
+//          work-stealing pool (dining_philosophers_tasks.h), which goes on to
+//          sizes a thread per philosopher cannot reach. Each run lasts
+//          --seconds (default 0.5) or --rounds meals. Requires C++17.
+//
+//          usage: ./dining_philosophers_bench [--seconds S] [--rounds N] [--work-ms W] [--think-ms T] [--contention]
+
+#include "dining_philosophers.h"
+#include "dining_philosophers_ordered.h"
+#include "dining_philosophers_tasks.h"
+#include <memory>
+#include <iomanip>
+
+// one line per run, the full per-philosopher counts would not fit
+template <typename P>
+void report(const char *name, int num_philosophers, std::chrono::steady_clock::duration elapsed,
+            std::vector<std::unique_ptr<P>> &philosophers){
+	double seconds = std::chrono::duration<double>(elapsed).count();
+	LatencyHistogram waits;
+	long total = 0;
+	long fewest = -1;
+	long most = 0;
+
+	for(auto &p : philosophers){
+		total += p->meals();
+		fewest = (fewest < 0 || p->meals() < fewest) ? p->meals() : fewest;
+		most = std::max<long>(most, p->meals());
+		waits.merge(p->waits());
+	}
+
+	std::cout << std::setw(8) << name << std::setw(8) << num_philosophers
+	          << std::setw(12) << total << std::setw(14) << std::fixed << std::setprecision(0) << total / seconds
+	          << std::setw(10) << std::setprecision(3) << (most > 0 ? (double)fewest / most : 0)
+	          << std::setw(14) << waits.percentile(99) << "\n";
+}
+
+// holds every philosopher back until all threads exist, so spawning thousands
+// of threads is not part of the measurement
+class StartGate {
+	public:
+		StartGate() : opened(false) {}
+
+		void wait(){
+			std::unique_lock<std::mutex> lck(mtx);
+			while(!opened)
+				cv.wait(lck);
+		}
+
+		void open(){
+			std::lock_guard<std::mutex> lck(mtx);
+			opened = true;
+			cv.notify_all();
+		}
+
+	private:
+		std::mutex mtx;
+		std::condition_variable cv;
+		bool opened;
+};
+
+// stops the run after the configured time, a meal budget stops it by itself
+template <typename Close>
+void run_for(const RunConfig &config, Close close){
+	if(config.duration.count() > 0){
+		std::this_thread::sleep_for(config.duration);
+		close();
+	}
+}
+
+// one mutex and condition variable for the whole table
+void bench_single(int num_philosophers, RunConfig config){
+	std::vector<int> chopsticks(num_philosophers, 1);
+	std::vector<std::unique_ptr<Philosopher>> philosophers;
+	std::vector<std::thread> threads;
+	StartGate gate;
+
+	Philosopher::open(config.rounds);
+	for(int i = 0; i < num_philosophers; ++i)
+		philosophers.emplace_back(new Philosopher(i, num_philosophers, config));
+
+	for(auto &p : philosophers){
+		Philosopher *philosopher = p.get();
+		threads.emplace_back([philosopher, &chopsticks, &gate](){
+			gate.wait();
+			while(philosopher->can_eat(chopsticks));
+		});
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	gate.open();
+
+	run_for(config, [](){ Philosopher::close(); });
+	for(std::thread &t : threads)
+		t.join();
+
+	report("single", num_philosophers, std::chrono::steady_clock::now() - start, philosophers);
+}
+
+// one mutex per chopstick, locked in ascending order
+void bench_ordered(int num_philosophers, RunConfig config){
+	ChopstickTable table(num_philosophers);
+	std::vector<std::unique_ptr<OrderedPhilosopher>> philosophers;
+	std::vector<std::thread> threads;
+	StartGate gate;
+
+	table.open(config.rounds);
+	for(int i = 0; i < num_philosophers; ++i)
+		philosophers.emplace_back(new OrderedPhilosopher(i, num_philosophers, config));
+
+	for(auto &p : philosophers){
+		OrderedPhilosopher *philosopher = p.get();
+		threads.emplace_back([philosopher, &table, &gate](){
+			gate.wait();
+			while(philosopher->can_eat(table));
+		});
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	gate.open();
+
+	run_for(config, [&table](){ table.close(); });
+	for(std::thread &t : threads)
+		t.join();
+
+	report("ordered", num_philosophers, std::chrono::steady_clock::now() - start, philosophers);
+}
+
+// per-chopstick wait lists, philosophers are tasks on one worker per core
+void bench_tasks(int num_philosophers, RunConfig config){
+	WorkStealingPool pool;
+	TaskChopstickTable table(num_philosophers);
+	std::vector<std::unique_ptr<PhilosopherTask>> philosophers;
+
+	table.open(config.rounds);
+	for(int i = 0; i < num_philosophers; ++i)
+		philosophers.emplace_back(new PhilosopherTask(i, num_philosophers, table, config));
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(auto &p : philosophers)
+		pool.spawn(p.get());
+
+	run_for(config, [&table, &pool](){ table.close(pool); });
+	pool.wait();
+
+	report("tasks", num_philosophers, std::chrono::steady_clock::now() - start, philosophers);
+}
+
+int main(int argc, char *argv[]){
+	RunConfig config;
+	std::vector<int> sizes = { 5, 16, 64, 256, 1024, 4096, 16384, 65536 };
+	int max_threads = 4096;
+
+	config.think = std::chrono::nanoseconds(0);
+	if(!parse_run_config(argc, argv, config))
+		return 1;
+	config.verbose = false;
+	ContentionSite::enable(config.contention);
+	if(!config.bounded())
+		config.duration = std::chrono::milliseconds(500);
+
+	std::cout << "hardware threads: " << std::thread::hardware_concurrency() << "\n";
+	std::cout << std::setw(8) << "table" << std::setw(8) << "N" << std::setw(12) << "meals"
+	          << std::setw(14) << "meals/sec" << std::setw(10) << "min/max" << std::setw(14) << "p99 wait ns" << "\n";
+
+	for(int n : sizes){
+		if(n <= max_threads){
+			bench_single(n, config);
+			bench_ordered(n, config);
+		}
+		bench_tasks(n, config);
+	}
+
+	if(config.contention)
+		print_contention_report(std::cout);
+
+	return 0;
+}
@@ -0,0 +1,128 @@
+// dining_philosophers_coro.h
+// author:  Joseph Perry
+// desc:    This file defines philosophers that are C++20 coroutines on an
+//          EventLoop (see concurrency/coroutine.h). Waiting for a chopstick
+//          and thinking or eating are co_awaits, so no thread ever blocks and
+//          a philosopher costs one coroutine frame plus a few counters.
+//          Chopsticks are taken in ascending order as in
+//          dining_philosophers_ordered.h. Requires C++20.
+
+#ifndef DINING_PHILOSOPHERS_CORO_H
+#define DINING_PHILOSOPHERS_CORO_H
+
+#include "dining_philosophers.h"
+#include "../concurrency/coroutine.h"
+
+// Shared table, the wait latency of every philosopher is kept here rather than
+// per philosopher to keep philosophers small
+class CoroChopstickTable {
+	public:
+		// constructor, one chopstick between each pair of neighbours
+		CoroChopstickTable(int);
+
+		// reopen the table, closing it once this many meals have been eaten in total, 0 is unbounded
+		void open(long = 0);
+
+		// stop every philosopher after their current meal
+		void close();
+
+		// getters
+		int inline size(){ return static_cast<int>(taken.size()); }
+		long inline meals(){ return total_meals; }
+		const LatencyHistogram& waits(){ return wait_times; }
+
+	private:
+		std::vector<bool> taken;
+		std::vector<WaitList> waiters;
+		bool closed;
+		long total_meals;
+		long meal_limit;
+		LatencyHistogram wait_times;
+
+		friend class CoroPhilosopher;
+};
+
+// constructor
+CoroChopstickTable::CoroChopstickTable(int num_chopsticks)
+	: taken(num_chopsticks, false), waiters(num_chopsticks), closed(false), total_meals(0), meal_limit(0) {}
+
+void CoroChopstickTable::open(long limit){
+	closed = false;
+	total_meals = 0;
+	meal_limit = limit;
+}
+
+void CoroChopstickTable::close(){
+	closed = true;
+	for(WaitList &w : waiters)
+		w.wake_all();
+}
+
+class CoroPhilosopher {
+	public:
+		CoroPhilosopher(int, int, RunConfig = RunConfig());
+
+		// the philosopher's whole life, spawn it on the table's loop
+		CoroAgent dine(EventLoop &, CoroChopstickTable &);
+
+		int inline meals(){ return num_dine; }
+	private:
+		int id;
+		int num_dine;
+		int first_chopstick;
+		int second_chopstick;
+		RunConfig config;
+};
+
+// the chopsticks are stored in lock order rather than as left and right
+CoroPhilosopher::CoroPhilosopher(int id, int num_philosophers, RunConfig config) : id(id), num_dine(0), config(config) {
+	int left = id;
+	int right = (id + 1) % num_philosophers;
+
+	first_chopstick = left < right ? left : right;
+	second_chopstick = left < right ? right : left;
+}
+
+// think, take the chopsticks in order, eat for the work time, put them back
+CoroAgent CoroPhilosopher::dine(EventLoop &loop, CoroChopstickTable &table){
+	while(!table.closed){
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		while(table.taken[first_chopstick] && !table.closed)
+			co_await table.waiters[first_chopstick].wait();
+		if(table.closed)
+			break;
+		table.taken[first_chopstick] = true;
+
+		// a lone philosopher has only one chopstick
+		if(second_chopstick != first_chopstick){
+			while(table.taken[second_chopstick] && !table.closed)
+				co_await table.waiters[second_chopstick].wait();
+			if(table.closed){
+				table.taken[first_chopstick] = false;
+				table.waiters[first_chopstick].wake_one();
+				break;
+			}
+			table.taken[second_chopstick] = true;
+		}
+
+		table.wait_times.record(std::chrono::steady_clock::now() - start);
+		num_dine++;
+		if(config.verbose)
+			log_event(" eating ... ", id, num_dine);
+		co_await loop.sleep_for(config.work);
+
+		table.taken[second_chopstick] = false;
+		table.taken[first_chopstick] = false;
+		table.waiters[second_chopstick].wake_one();
+		table.waiters[first_chopstick].wake_one();
+
+		// the meal budget is spent, everyone leaves the table
+		if(++table.total_meals >= table.meal_limit && table.meal_limit > 0)
+			table.close();
+
+		co_await loop.sleep_for(config.think);
+	}
+}
+
+#endif
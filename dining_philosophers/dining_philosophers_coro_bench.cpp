@@ -0,0 +1,186 @@
+// dining_philosophers_coro_bench.cpp
+// author:  Joseph Perry
+// desc:    Compares the coroutine philosophers in dining_philosophers_coro.h
+//          with a thread per philosopher (dining_philosophers_ordered.h):
+//          meals/sec and resident memory per philosopher for a large table,
+//          and the cost of one switch between two agents that hand control
+//          back and forth. Resident memory is read from /proc/self/status.
+//          Requires C++20.
+//
+//          usage: ./dining_philosophers_coro_bench [--seconds S] [--think-ms T] [--work-ms W]
+//                                                  [--coroutines N] [--threads N]
+
+#include "dining_philosophers_ordered.h"
+#include "dining_philosophers_coro.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <memory>
+
+// resident set size of this process, 0 if it cannot be read
+long resident_bytes(){
+	std::ifstream status("/proc/self/status");
+	std::string line;
+
+	while(std::getline(status, line))
+		if(line.compare(0, 6, "VmRSS:") == 0){
+			std::istringstream ss(line.substr(6));
+			long kb = 0;
+
+			ss >> kb;
+			return kb * 1024;
+		}
+
+	return 0;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char *name, int num_philosophers, long meals, double seconds, long bytes){
+	std::cout << name << ": " << num_philosophers << " philosophers, " << meals << " meals, "
+	          << (long)(meals / seconds) << " meals/sec, " << bytes / num_philosophers << " resident bytes/philosopher\n";
+}
+
+// every philosopher is a coroutine on one thread; a closer agent ends the run
+void bench_coroutines(int num_philosophers, RunConfig config){
+	long before = resident_bytes();
+	EventLoop loop;
+	CoroChopstickTable table(num_philosophers);
+	std::vector<CoroPhilosopher> philosophers;
+	long during;
+
+	philosophers.reserve(num_philosophers);
+	for(int i = 0; i < num_philosophers; ++i)
+		philosophers.emplace_back(i, num_philosophers, config);
+	for(CoroPhilosopher &p : philosophers)
+		loop.spawn(p.dine(loop, table));
+	during = resident_bytes();
+
+	std::cout << "coroutine frame: " << CoroAgent::frame_bytes() / CoroAgent::frames() << " bytes\n";
+
+	loop.spawn([](EventLoop &loop, CoroChopstickTable &table, std::chrono::nanoseconds d) -> CoroAgent {
+		co_await loop.sleep_for(d);
+		table.close();
+	}(loop, table, config.duration));
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	loop.run();
+	report("coroutines", num_philosophers, table.meals(), seconds_since(start), during - before);
+}
+
+// a thread per philosopher, resident memory taken once every thread has started
+void bench_threads(int num_philosophers, RunConfig config){
+	long before = resident_bytes();
+	ChopstickTable table(num_philosophers);
+	std::vector<std::unique_ptr<OrderedPhilosopher>> philosophers;
+	std::vector<std::thread> threads;
+	long during, meals = 0;
+
+	for(int i = 0; i < num_philosophers; ++i)
+		philosophers.emplace_back(new OrderedPhilosopher(i, num_philosophers, config));
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(auto &p : philosophers){
+		OrderedPhilosopher *philosopher = p.get();
+		threads.emplace_back([philosopher, &table](){ while(philosopher->can_eat(table)); });
+	}
+	during = resident_bytes();
+
+	std::this_thread::sleep_for(config.duration);
+	table.close();
+	for(std::thread &t : threads)
+		t.join();
+
+	for(auto &p : philosophers)
+		meals += p->meals();
+	report("threads", num_philosophers, meals, seconds_since(start), during - before);
+}
+
+// two coroutines wake each other in turn, each handoff is one switch
+void bench_coroutine_switch(long switches){
+	EventLoop loop;
+	WaitList lists[2];
+	long turn = 0;
+
+	for(int me = 0; me < 2; ++me)
+		loop.spawn([](WaitList *lists, long &turn, int me, long switches) -> CoroAgent {
+			while(turn < switches){
+				while(turn % 2 != me && turn < switches)
+					co_await lists[me].wait();
+				++turn;
+				lists[1 - me].wake_one();
+			}
+		}(lists, turn, me, switches));
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	loop.run();
+	std::cout << "coroutine switch: " << seconds_since(start) * 1e9 / switches << " ns\n";
+}
+
+// two threads wake each other in turn through a condition variable
+void bench_thread_switch(long switches){
+	std::mutex mtx;
+	std::condition_variable cv[2];
+	long turn = 0;
+	std::vector<std::thread> threads;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(int me = 0; me < 2; ++me)
+		threads.emplace_back([&, me](){
+			std::unique_lock<std::mutex> lck(mtx);
+
+			while(turn < switches){
+				while(turn % 2 != me && turn < switches)
+					cv[me].wait(lck);
+				++turn;
+				cv[1 - me].notify_one();
+			}
+		});
+	for(std::thread &t : threads)
+		t.join();
+
+	std::cout << "thread switch: " << seconds_since(start) * 1e9 / switches << " ns\n";
+}
+
+int main(int argc, char *argv[]){
+	RunConfig config;
+	int coroutines = 100000;
+	int threads = 1000;
+	std::vector<char*> rest(1, argv[0]);
+
+	// our own options first, everything else is a run option
+	for(int i = 1; i < argc; ++i){
+		std::string option = argv[i];
+
+		if((option == "--coroutines" || option == "--threads") && i + 1 < argc){
+			std::istringstream ss(argv[++i]);
+			int value;
+
+			if(!(ss >> value) || value <= 0){
+				std::cerr << "Invalid input : " << argv[i] << "\n";
+				return 1;
+			}
+			(option == "--coroutines" ? coroutines : threads) = value;
+		} else {
+			rest.push_back(argv[i]);
+		}
+	}
+
+	config.think = std::chrono::milliseconds(1);
+	config.work = std::chrono::microseconds(100);
+	config.duration = std::chrono::seconds(1);
+	if(!parse_run_config(static_cast<int>(rest.size()), rest.data(), config))
+		return 1;
+	config.verbose = false;
+	if(config.duration.count() == 0)
+		config.duration = std::chrono::seconds(1);
+
+	bench_coroutines(coroutines, config);
+	bench_threads(threads, config);
+	bench_coroutine_switch(1000000);
+	bench_thread_switch(100000);
+
+	return 0;
+}
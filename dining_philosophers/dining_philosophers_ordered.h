@@ -0,0 +1,147 @@
+// dining_philosophers_ordered.h
+// author:  Joseph Perry
+// desc:    This file defines a variant of the Philosopher class in which every
+//          chopstick is its own mutex. A philosopher locks the chopsticks it
+//          needs in ascending order, so there is a global lock order and no
+//          deadlock, and philosophers who share no chopstick never touch the
+//          same lock. There is no table-wide lock or broadcast; a waiting
+//          philosopher sleeps in the mutex of the chopstick it is missing.
+
+#ifndef DINING_PHILOSOPHERS_ORDERED_H
+#define DINING_PHILOSOPHERS_ORDERED_H
+
+#include "dining_philosophers.h"
+#include "topology.h"
+#include <atomic>
+
+// Shared table, one mutex per chopstick
+class ChopstickTable {
+	public:
+		// constructor, one chopstick between each pair of neighbours
+		ChopstickTable(int);
+
+		// reopen the table, closing it once this many meals have been eaten in total, 0 is unbounded
+		void open(long = 0);
+
+		// stop every philosopher after their current meal
+		void close();
+
+		// getter for the number of chopsticks
+		int inline size(){ return static_cast<int>(chopsticks.size()); }
+
+	private:
+		// padded to a cache line so neighbouring chopsticks do not false-share
+		struct alignas(64) Chopstick {
+			std::mutex mtx;
+		};
+
+		std::vector<Chopstick> chopsticks;
+		std::atomic<bool> closed;
+		std::atomic<long> total_meals;
+		long meal_limit;
+
+		friend class OrderedPhilosopher;
+};
+
+// constructor
+ChopstickTable::ChopstickTable(int num_chopsticks) : chopsticks(num_chopsticks), closed(false), total_meals(0), meal_limit(0) {}
+
+// not safe while philosophers are eating
+void ChopstickTable::open(long limit){
+	closed.store(false);
+	total_meals.store(0);
+	meal_limit = limit;
+}
+
+void ChopstickTable::close(){
+	closed.store(true, std::memory_order_release);
+}
+
+class OrderedPhilosopher {
+	public:
+		OrderedPhilosopher(int, int, RunConfig = RunConfig());
+		OrderedPhilosopher(int, std::vector<int>, RunConfig = RunConfig());
+		bool can_eat(ChopstickTable &);
+		int inline meals(){ return num_dine; }
+		const LatencyHistogram& waits(){ return wait_times; }
+	private:
+		Philosopher_state state;
+		int id;
+		int num_dine;
+		std::vector<int> needs;                    // sorted, which is the lock order
+		RunConfig config;
+		LatencyHistogram wait_times;
+		void get_chopsticks(ChopstickTable &);
+		void put_back_chopsticks(ChopstickTable &);
+		void eat();
+		void think();
+};
+
+// seated in a ring, between chopsticks id and id + 1
+OrderedPhilosopher::OrderedPhilosopher(int id, int num_philosophers, RunConfig config)
+	: OrderedPhilosopher(id, std::vector<int>{ id, (id + 1) % num_philosophers }, config) {}
+
+// the chopsticks are stored in lock order, a lone philosopher's ring has only one
+OrderedPhilosopher::OrderedPhilosopher(int id, std::vector<int> chopsticks, RunConfig config) : state(Philosopher_state::Thinking),
+										id(id),
+										num_dine(0),
+										needs(chopsticks),
+										config(config) {
+
+	normalize(needs);
+}
+
+// returns false once the table has been closed
+bool OrderedPhilosopher::can_eat(ChopstickTable &table){
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if(table.closed.load(std::memory_order_acquire))
+		return false;
+
+	get_chopsticks(table);
+
+	// closed while we were waiting
+	if(table.closed.load(std::memory_order_acquire)){
+		put_back_chopsticks(table);
+		return false;
+	}
+
+	wait_times.record(std::chrono::steady_clock::now() - start);
+
+	eat();
+	pause_for(config.work);
+
+	put_back_chopsticks(table);
+
+	// the meal budget is spent, everyone leaves the table
+	if(table.meal_limit > 0 && table.total_meals.fetch_add(1, std::memory_order_relaxed) + 1 >= table.meal_limit)
+		table.close();
+
+	think();
+	return true;
+}
+
+// lowest numbered chopstick first
+void OrderedPhilosopher::get_chopsticks(ChopstickTable &table){
+	for(int c : needs)
+		table.chopsticks[c].mtx.lock();
+}
+
+void OrderedPhilosopher::put_back_chopsticks(ChopstickTable &table){
+	for(auto it = needs.rbegin(); it != needs.rend(); ++it)
+		table.chopsticks[*it].mtx.unlock();
+}
+
+void OrderedPhilosopher::eat(){
+	state = Philosopher_state::Dining;
+	num_dine++;
+	if(config.verbose)
+		log_event(" eating ... ", id, num_dine);
+}
+
+void OrderedPhilosopher::think(){
+	state = Philosopher_state::Thinking;
+	pause_for(config.think);
+}
+
+#endif
@@ -0,0 +1,219 @@
+// dining_philosophers_tasks.h
+// author:  Joseph Perry
+// desc:    This file defines philosophers that run as tasks on a
+//          WorkStealingPool (see concurrency/work_stealing.h) rather than on a
+//          thread each. Chopsticks are taken in ascending order as in
+//          dining_philosophers_ordered.h, but a philosopher whose chopstick is
+//          taken parks on that chopstick and is resumed when it is put back,
+//          instead of blocking its thread. Tens of thousands of philosophers
+//          can share a pool of a few workers.
+//
+//          Think and work times are not simulated, a task must never sleep on
+//          its worker.
+
+#ifndef DINING_PHILOSOPHERS_TASKS_H
+#define DINING_PHILOSOPHERS_TASKS_H
+
+#include "dining_philosophers.h"
+#include "../concurrency/work_stealing.h"
+#include <atomic>
+
+// Shared table, each chopstick has a short lock and a list of parked philosophers
+class TaskChopstickTable {
+	public:
+		// constructor, one chopstick between each pair of neighbours
+		TaskChopstickTable(int);
+
+		// reopen the table, closing it once this many meals have been eaten in total, 0 is unbounded
+		void open(long = 0);
+
+		// stop every philosopher after their current meal, parked ones are resumed to leave
+		void close(WorkStealingPool &);
+
+		// getter for the number of chopsticks
+		int inline size(){ return static_cast<int>(chopsticks.size()); }
+
+	private:
+		enum class Take : int { Taken, Parked, Closed };
+
+		// padded to a cache line so neighbouring chopsticks do not false-share
+		struct alignas(64) Chopstick {
+			std::mutex mtx;
+			bool taken;
+			std::deque<Task*> waiters;
+
+			Chopstick() : taken(false) {}
+		};
+
+		std::vector<Chopstick> chopsticks;
+		std::atomic<bool> closed;
+		std::atomic<long> total_meals;
+		long meal_limit;
+
+		// take chopstick i, or park task on it until it is put back
+		Take take(int, Task*);
+
+		// put chopstick i back and resume the philosopher waiting longest for it
+		void put_back(int, WorkStealingPool &);
+
+		friend class PhilosopherTask;
+};
+
+// constructor
+TaskChopstickTable::TaskChopstickTable(int num_chopsticks) : chopsticks(num_chopsticks), closed(false), total_meals(0), meal_limit(0) {}
+
+// not safe while philosophers are eating
+void TaskChopstickTable::open(long limit){
+	closed.store(false);
+	total_meals.store(0);
+	meal_limit = limit;
+}
+
+// closed is set before the sweep, so a philosopher that parks after its
+// chopstick was swept sees it under the chopstick lock and does not park
+void TaskChopstickTable::close(WorkStealingPool &pool){
+	closed.store(true);
+
+	for(Chopstick &c : chopsticks){
+		std::deque<Task*> waiters;
+
+		{
+			std::lock_guard<std::mutex> lck(c.mtx);
+			waiters.swap(c.waiters);
+		}
+
+		for(Task *t : waiters)
+			pool.resume(t);
+	}
+}
+
+TaskChopstickTable::Take TaskChopstickTable::take(int i, Task *task){
+	std::lock_guard<std::mutex> lck(chopsticks[i].mtx);
+
+	if(!chopsticks[i].taken){
+		chopsticks[i].taken = true;
+		return Take::Taken;
+	}
+
+	if(closed.load())
+		return Take::Closed;
+
+	chopsticks[i].waiters.push_back(task);
+	return Take::Parked;
+}
+
+void TaskChopstickTable::put_back(int i, WorkStealingPool &pool){
+	Task *next = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lck(chopsticks[i].mtx);
+
+		chopsticks[i].taken = false;
+		if(!chopsticks[i].waiters.empty()){
+			next = chopsticks[i].waiters.front();
+			chopsticks[i].waiters.pop_front();
+		}
+	}
+
+	if(next != nullptr)
+		pool.resume(next);
+}
+
+// One meal per step: take both chopsticks (parking on whichever is taken), eat,
+// put them back and yield so the worker moves on to another philosopher
+class PhilosopherTask : public Task {
+	public:
+		PhilosopherTask(int, int, TaskChopstickTable &, RunConfig = RunConfig());
+		Task_state run(WorkStealingPool &);
+		int inline meals(){ return num_dine; }
+		const LatencyHistogram& waits(){ return wait_times; }
+	private:
+		Philosopher_state state;
+		int id;
+		int num_dine;
+		int first_chopstick;
+		int second_chopstick;
+		int held;                                   // chopsticks taken so far this meal
+		bool hungry;                                // started waiting for this meal
+		std::chrono::steady_clock::time_point start;
+		TaskChopstickTable &table;
+		RunConfig config;
+		LatencyHistogram wait_times;
+		Task_state leave(WorkStealingPool &);
+		void eat();
+};
+
+// the chopsticks are stored in lock order rather than as left and right
+PhilosopherTask::PhilosopherTask(int id, int num_philosophers, TaskChopstickTable &table, RunConfig config)
+	: state(Philosopher_state::Thinking), id(id), num_dine(0), held(0), hungry(false), table(table), config(config) {
+
+	int left = id;
+	int right = (id + 1) % num_philosophers;
+
+	first_chopstick = left < right ? left : right;
+	second_chopstick = left < right ? right : left;
+}
+
+// resumed here after parking, held says how far the last step got
+Task_state PhilosopherTask::run(WorkStealingPool &pool){
+	TaskChopstickTable::Take taken;
+
+	if(table.closed.load(std::memory_order_acquire))
+		return leave(pool);
+
+	if(!hungry){
+		hungry = true;
+		start = std::chrono::steady_clock::now();
+	}
+
+	if(held == 0){
+		taken = table.take(first_chopstick, this);
+		if(taken == TaskChopstickTable::Take::Parked)
+			return Task_state::Parked;
+		if(taken == TaskChopstickTable::Take::Closed)
+			return leave(pool);
+		held = 1;
+	}
+
+	if(held == 1 && second_chopstick != first_chopstick){
+		taken = table.take(second_chopstick, this);
+		if(taken == TaskChopstickTable::Take::Parked)
+			return Task_state::Parked;
+		if(taken == TaskChopstickTable::Take::Closed)
+			return leave(pool);
+	}
+	held = 2;
+
+	wait_times.record(std::chrono::steady_clock::now() - start);
+	eat();
+
+	if(second_chopstick != first_chopstick)
+		table.put_back(second_chopstick, pool);
+	table.put_back(first_chopstick, pool);
+	held = 0;
+	hungry = false;
+	state = Philosopher_state::Thinking;
+
+	// the meal budget is spent, everyone leaves the table
+	if(table.meal_limit > 0 && table.total_meals.fetch_add(1, std::memory_order_relaxed) + 1 == table.meal_limit)
+		table.close(pool);
+
+	return Task_state::Yield;
+}
+
+// give back anything held so neighbours can leave too
+Task_state PhilosopherTask::leave(WorkStealingPool &pool){
+	if(held >= 1)
+		table.put_back(first_chopstick, pool);
+	held = 0;
+	return Task_state::Done;
+}
+
+void PhilosopherTask::eat(){
+	state = Philosopher_state::Dining;
+	num_dine++;
+	if(config.verbose)
+		log_event(" eating ... ", id, num_dine);
+}
+
+#endif
@@ -0,0 +1,102 @@
+// topology.h
+// author:  Joseph Perry
+// desc:    This file defines table topologies for the dining philosophers: for
+//          each philosopher, the set of chopsticks they need to eat. The
+//          classic table is a ring; a general resource graph gives every
+//          philosopher an arbitrary set, either at random or read from a file
+//          with one philosopher per line, listing chopstick numbers.
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+// needs[i] is the sorted, distinct chopsticks philosopher i needs
+typedef std::vector<std::vector<int>> Topology;
+
+// sorts and removes duplicates, the lock order for every table
+void normalize(std::vector<int> &chopsticks){
+	std::sort(chopsticks.begin(), chopsticks.end());
+	chopsticks.erase(std::unique(chopsticks.begin(), chopsticks.end()), chopsticks.end());
+}
+
+// n philosophers in a ring, each shares a chopstick with each neighbour
+Topology ring_topology(int n){
+	Topology needs(n);
+
+	for(int i = 0; i < n; ++i){
+		needs[i] = { i, (i + 1) % n };
+		normalize(needs[i]);
+	}
+
+	return needs;
+}
+
+// n philosophers, each needs k distinct chopsticks chosen at random out of m
+Topology random_topology(int n, int m, int k, unsigned seed){
+	std::mt19937 rng(seed);
+	std::vector<int> all(m);
+	Topology needs(n);
+
+	for(int c = 0; c < m; ++c)
+		all[c] = c;
+
+	for(int i = 0; i < n; ++i){
+		// partial Fisher-Yates, the first k entries are the sample
+		for(int j = 0; j < k; ++j)
+			std::swap(all[j], all[j + rng() % (m - j)]);
+		needs[i].assign(all.begin(), all.begin() + k);
+		normalize(needs[i]);
+	}
+
+	return needs;
+}
+
+// one line per philosopher, whitespace separated chopstick numbers; blank
+// lines and lines whose first non-blank character is # are skipped. false if
+// a line is malformed
+bool read_topology(std::istream &in, Topology &needs){
+	std::string line;
+
+	needs.clear();
+	while(std::getline(in, line)){
+		std::istringstream ss(line);
+		std::vector<int> chopsticks;
+		size_t first = line.find_first_not_of(" \t\r");
+		int c;
+
+		if(first == std::string::npos || line[first] == '#')
+			continue;
+
+		while(ss >> c){
+			if(c < 0)
+				return false;
+			chopsticks.push_back(c);
+		}
+		if(!ss.eof() || chopsticks.empty())
+			return false;
+
+		normalize(chopsticks);
+		needs.push_back(chopsticks);
+	}
+
+	return true;
+}
+
+// one more than the highest chopstick anyone needs
+int chopstick_count(const Topology &needs){
+	int count = 0;
+
+	for(const std::vector<int> &chopsticks : needs)
+		if(!chopsticks.empty())
+			count = std::max(count, chopsticks.back() + 1);
+
+	return count;
+}
+
+#endif
@@ -0,0 +1,411 @@
+// doubly_linked_list.h
+// author:  Joseph Perry
+// desc:    This file defines a custom doubly-linked DoublyLinkedList class with
+//          O(1) push/pop at both ends and O(1) insert/erase/splice via iterators.
+//          LinkedList (linked_list.h) remains the smaller singly-linked option.
+
+#ifndef DOUBLY_LINKED_LIST_H
+#define DOUBLY_LINKED_LIST_H
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+#include <iterator>
+#include "linked_list.h"
+
+template <typename T>
+class DoublyLinkedList {
+    private:
+        class Node {
+            private:
+                T data;
+                Node *prev;
+                Node *next;
+            public:
+                Node(T data) : data(data), prev(nullptr), next(nullptr) {}
+                friend class DoublyLinkedList;
+        };
+        Node *head;
+        Node *tail;
+        size_t num_nodes;
+
+        void link_before(Node*, Node*);                     // link node before pos (nullptr = end)
+        void unlink(Node*);                                 // unlink node, does not delete it
+
+    public:
+        // bidirectional iterator, end() is represented by a null node
+        template <typename V>
+        class Iterator {
+            private:
+                Node *node;
+                const DoublyLinkedList *list;
+            public:
+                typedef std::bidirectional_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef V* pointer;
+                typedef V& reference;
+
+                Iterator() : node(nullptr), list(nullptr) {}
+                Iterator(Node *node, const DoublyLinkedList *list) : node(node), list(list) {}
+
+                // allow iterator -> const_iterator
+                operator Iterator<const T>() const { return Iterator<const T>(node, list); }
+
+                reference operator*() const { return node->data; }
+                pointer operator->() const { return &node->data; }
+                Iterator& operator++(){ node = node->next; return *this; }
+                Iterator operator++(int){ Iterator it = *this; node = node->next; return it; }
+                Iterator& operator--(){ node = (node == nullptr) ? list->tail : node->prev; return *this; }
+                Iterator operator--(int){ Iterator it = *this; --(*this); return it; }
+                bool operator==(const Iterator &other) const { return node == other.node; }
+                bool operator!=(const Iterator &other) const { return node != other.node; }
+
+                friend class DoublyLinkedList;
+        };
+        typedef Iterator<T> iterator;
+        typedef Iterator<const T> const_iterator;
+
+        DoublyLinkedList();                                         // empty constructor
+        DoublyLinkedList(T);                                        // element constructor
+        DoublyLinkedList(const DoublyLinkedList<T>&);               // copy constructor
+        ~DoublyLinkedList();                                        // destructor
+        DoublyLinkedList<T>& operator=(const DoublyLinkedList<T>&); // assignment operator
+        bool operator != (const DoublyLinkedList<T>&) const;        // not equal operator
+        bool operator == (const DoublyLinkedList<T>&) const;        // is equal operator
+        void print_list();                                          // list printer
+        void push_back(T);                                          // add element to end of list
+        void push_front(T);                                         // add element to front of list
+        T find_first(T);                                            // find the first instance of item
+        T find_last(T);                                             // find the last instance of item
+        T pop_front();                                              // normally returns void
+        T pop_back();                                               // normally returns void
+        T front();                                                  // return first element
+        T back();                                                   // return last element
+        void clear();                                               // clear all elements from list
+        void reverse();                                             // reverse the list in place
+        inline size_t size();
+
+        iterator begin(){ return iterator(head, this); }
+        iterator end(){ return iterator(nullptr, this); }
+        const_iterator begin() const { return const_iterator(head, this); }
+        const_iterator end() const { return const_iterator(nullptr, this); }
+
+        iterator insert(iterator, T);                               // insert before position
+        iterator erase(iterator);                                   // erase at position, returns next
+        void splice(iterator, DoublyLinkedList<T>&);                // move all of other before position
+        void splice(iterator, DoublyLinkedList<T>&, iterator);      // move one element of other before position
+};
+
+// empty constructor
+template <typename T>
+DoublyLinkedList<T>::DoublyLinkedList(){
+    head = nullptr;
+    tail = head;
+    num_nodes = 0;
+}
+
+// element constructor
+template <typename T>
+DoublyLinkedList<T>::DoublyLinkedList(T a){
+    head = new Node(a);
+    tail = head;
+    num_nodes = 1;
+}
+
+// copy constructor
+template <typename T>
+DoublyLinkedList<T>::DoublyLinkedList(const DoublyLinkedList<T> &other){
+    head = nullptr;
+    tail = nullptr;
+    num_nodes = 0;
+
+    for(Node *p = other.head; p != nullptr; p = p->next)
+        push_back(p->data);
+}
+
+// destructor
+template <typename T>
+DoublyLinkedList<T>::~DoublyLinkedList(){
+    clear();
+}
+
+// assignment
+template <typename T>
+DoublyLinkedList<T>& DoublyLinkedList<T>::operator=(const DoublyLinkedList<T> &other){
+    // detect self-assignment, prevent self-deletion
+    if(this == &other)
+        return *this;
+
+    clear();
+
+    for(Node *p = other.head; p != nullptr; p = p->next)
+        push_back(p->data);
+
+    return *this;
+}
+
+template <typename T>
+bool DoublyLinkedList<T>::operator!=(const DoublyLinkedList<T> &other) const {
+    return !(*this == other);
+}
+
+template <typename T>
+bool DoublyLinkedList<T>::operator==(const DoublyLinkedList<T> &other) const {
+    Node *n = head;
+    Node *p = other.head;
+
+    // different lengths can never be equal
+    if(num_nodes != other.num_nodes)
+        return false;
+
+    while(n != nullptr){
+        if(n->data != p->data)
+            return false;
+        n = n->next;
+        p = p->next;
+    }
+
+    return true;
+}
+
+// links node before pos, a null pos appends to the end
+template <typename T>
+void DoublyLinkedList<T>::link_before(Node *pos, Node *node){
+    if(pos == nullptr){
+        node->prev = tail;
+        node->next = nullptr;
+        if(tail != nullptr)
+            tail->next = node;
+        else
+            head = node;
+        tail = node;
+    } else {
+        node->prev = pos->prev;
+        node->next = pos;
+        if(pos->prev != nullptr)
+            pos->prev->next = node;
+        else
+            head = node;
+        pos->prev = node;
+    }
+    ++num_nodes;
+}
+
+// removes node from the chain without freeing it
+template <typename T>
+void DoublyLinkedList<T>::unlink(Node *node){
+    if(node->prev != nullptr)
+        node->prev->next = node->next;
+    else
+        head = node->next;
+
+    if(node->next != nullptr)
+        node->next->prev = node->prev;
+    else
+        tail = node->prev;
+
+    node->prev = nullptr;
+    node->next = nullptr;
+    --num_nodes;
+}
+
+template <typename T>
+void DoublyLinkedList<T>::clear(){
+    Node *node = head;
+    Node *prev = node;
+
+    while(node != nullptr){
+        node = node->next;
+        delete prev;
+        prev = node;
+    }
+
+    head = nullptr;
+    tail = nullptr;
+    num_nodes = 0;
+}
+
+template <typename T>
+void DoublyLinkedList<T>::push_front(T data){
+    link_before(head, new Node(data));
+}
+
+template <typename T>
+void DoublyLinkedList<T>::push_back(T data){
+    link_before(nullptr, new Node(data));
+}
+
+template <typename T>
+T DoublyLinkedList<T>::front(){
+    if(head != nullptr)
+        return head->data;
+    else
+        throw ZeroLengthException();
+}
+
+template <typename T>
+T DoublyLinkedList<T>::back(){
+    if(tail != nullptr)
+        return tail->data;
+    else
+        throw ZeroLengthException();
+}
+
+template <typename T>
+void DoublyLinkedList<T>::print_list(){
+    Node *p = head;
+
+    if(p != nullptr)
+        while(p != nullptr){
+            std::cout << p->data << " ";
+            p = p->next;
+        }
+    else
+        std::cout << "Empty list";
+    std::cout << std::endl;
+}
+
+template <typename T>
+T DoublyLinkedList<T>::find_first(T a){
+    Node *p = head;
+
+    while(p != nullptr && p->data != a)
+        p = p->next;
+
+    if(p != nullptr)
+        return p->data;
+    else
+        throw ZeroLengthException();
+}
+
+// walks backwards from the tail, stops at the first match
+template <typename T>
+T DoublyLinkedList<T>::find_last(T a){
+    Node *p = tail;
+
+    while(p != nullptr && p->data != a)
+        p = p->prev;
+
+    if(p != nullptr)
+        return p->data;
+    else
+        throw ZeroLengthException();
+}
+
+template <typename T>
+T DoublyLinkedList<T>::pop_front(){
+    if(head != nullptr){
+        Node *node = head;
+        T data = node->data;
+
+        unlink(node);
+        delete node;
+        return data;
+    } else {
+        throw ZeroLengthException();
+    }
+}
+
+template <typename T>
+T DoublyLinkedList<T>::pop_back(){
+    if(tail != nullptr){
+        Node *node = tail;
+        T data = node->data;
+
+        unlink(node);
+        delete node;
+        return data;
+    } else {
+        throw ZeroLengthException();
+    }
+}
+
+template <typename T>
+void DoublyLinkedList<T>::reverse(){
+    Node *cur = head;
+    Node *next;
+
+    while(cur != nullptr){
+        next = cur->next;
+        cur->next = cur->prev;
+        cur->prev = next;
+        cur = next;
+    }
+
+    cur = head;
+    head = tail;
+    tail = cur;
+}
+
+template <typename T>
+inline size_t DoublyLinkedList<T>::size(){ return num_nodes; }
+
+// inserts data before pos, returns an iterator to the new element
+template <typename T>
+typename DoublyLinkedList<T>::iterator DoublyLinkedList<T>::insert(iterator pos, T data){
+    Node *node = new Node(data);
+
+    link_before(pos.node, node);
+    return iterator(node, this);
+}
+
+// erases the element at pos, returns an iterator to the element after it
+template <typename T>
+typename DoublyLinkedList<T>::iterator DoublyLinkedList<T>::erase(iterator pos){
+    Node *node = pos.node;
+    Node *next;
+
+    if(node == nullptr)
+        throw ZeroLengthException();
+
+    next = node->next;
+    unlink(node);
+    delete node;
+    return iterator(next, this);
+}
+
+// relinks every node of other before pos, other is left empty
+template <typename T>
+void DoublyLinkedList<T>::splice(iterator pos, DoublyLinkedList<T> &other){
+    Node *p = pos.node;
+
+    if(this == &other || other.head == nullptr)
+        return;
+
+    if(p == nullptr){
+        other.head->prev = tail;
+        if(tail != nullptr)
+            tail->next = other.head;
+        else
+            head = other.head;
+        tail = other.tail;
+    } else {
+        other.head->prev = p->prev;
+        other.tail->next = p;
+        if(p->prev != nullptr)
+            p->prev->next = other.head;
+        else
+            head = other.head;
+        p->prev = other.tail;
+    }
+
+    num_nodes += other.num_nodes;
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.num_nodes = 0;
+}
+
+// relinks the single node at it (owned by other) before pos
+template <typename T>
+void DoublyLinkedList<T>::splice(iterator pos, DoublyLinkedList<T> &other, iterator it){
+    Node *node = it.node;
+
+    if(node == nullptr || node == pos.node)
+        return;
+
+    other.unlink(node);
+    link_before(pos.node, node);
+}
+
+#endif
@@ -1,4 +1,7 @@
 #include "linked_list.h"
+#include "doubly_linked_list.h"
+#include <algorithm>
+#include <vector>
 
 using namespace std;
 
@@ -59,5 +62,65 @@ int main(int argc, char *argv[]){
 
     // cout << linked_list << endl;
 
+    // doubly-linked list, used as a deque
+    DoublyLinkedList<string> deque;
+    DoublyLinkedList<string> other("x");
+
+    deque.push_back("b");
+    deque.push_back("c");
+    deque.push_front("a");
+    deque.print_list();
+    cout << deque.pop_back() << " " << deque.pop_front() << endl;
+    cout << deque.pop_back() << " " << deque.size() << endl;
+
+    other.push_back("y");
+    other.push_back("z");
+    deque.splice(deque.end(), other);
+    deque.insert(++deque.begin(), "w");
+    deque.erase(--deque.end());
+    deque.print_list();
+    other.print_list();
+
+    // iterators, in-place modification and <algorithm> interop
+    LinkedList<int> numbers;
+    LinkedList<int> more;
+    LinkedList<int>::iterator it;
+
+    for(int i = 5; i > 0; --i)
+        numbers.push_front(i);
+    more.push_back(10);
+    more.push_back(11);
+
+    it = numbers.insert_after(numbers.begin(), 42);
+    numbers.erase_after(it);
+    numbers.splice_after(numbers.before_begin(), more);
+
+    for(int &n : numbers)
+        n *= 2;
+
+    for(const int n : numbers)
+        cout << n << " ";
+    cout << endl;
+
+    cout << *max_element(numbers.begin(), numbers.end()) << " "
+         << count_if(numbers.cbegin(), numbers.cend(), [](int n){ return n > 8; }) << " "
+         << numbers.size() << " " << numbers.back() << endl;
+
+    // bulk construction and zero-copy concat/split
+    vector<string> batch = { "m", "n", "o", "p" };
+    LinkedList<string> merged(batch.begin(), batch.end());
+    LinkedList<string> tail_half;
+
+    merged.concat(l3);
+    merged.print_list();
+    tail_half = merged.split_at(3);
+    merged.print_list();
+    tail_half.print_list();
+    cout << merged.size() << " " << tail_half.size() << " " << l3.size() << endl;
+    tail_half.pop_front();
+    tail_half.push_back("q");
+    merged.concat(tail_half);
+    merged.print_list();
+
     return 0;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 // linked_list.h
 // author:  Joseph Perry
 // desc:    This file defines a custom singly-linked LinkedList class
+//          (see doubly_linked_list.h for O(1) operations at both ends)
 
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
@@ -9,6 +10,8 @@
 #include <string>
 #include <cstddef>
 #include <exception>
+#include <iterator>
+#include <new>
 
 struct ZeroLengthException : public std::exception {
    const char * what () const throw () {
@@ -19,23 +22,75 @@ struct ZeroLengthException : public std::exception {
 template <typename T>
 class LinkedList {
     private:
+        // header of a pooled allocation shared by a run of nodes, freed
+        // when its last live node is destroyed (in whichever list owns it)
+        struct NodeBlock {
+            size_t live;
+        };
         template <typename U>
         class Node {
             private:
                 U data;
                 Node *next;
+                NodeBlock *block;                           // nullptr if allocated on its own
             public:
-                Node(U data) : data(data), next(nullptr) {}
+                Node(U data) : data(data), next(nullptr), block(nullptr) {}
                 friend class LinkedList;
         };
         Node<T> *head;
         Node<T> *tail;
         size_t num_nodes;
+
+        template <typename It>
+        void append_range(It, It);                          // append copies, one allocation if It is multi-pass
+        template <typename It>
+        void append_range(It, It, std::input_iterator_tag);
+        template <typename It>
+        void append_range(It, It, std::forward_iterator_tag);
+        void destroy_node(Node<T>*);                        // delete or release pooled node
     public:
+        // forward iterator, end() is represented by a null node and
+        // before_begin() by a null node flagged as preceding head
+        template <typename V>
+        class Iterator {
+            private:
+                Node<T> *node;
+                const LinkedList *list;
+                bool before;
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef V* pointer;
+                typedef V& reference;
+
+                Iterator() : node(nullptr), list(nullptr), before(false) {}
+                Iterator(Node<T> *node, const LinkedList *list, bool before = false) : node(node), list(list), before(before) {}
+
+                // allow iterator -> const_iterator
+                operator Iterator<const T>() const { return Iterator<const T>(node, list, before); }
+
+                reference operator*() const { return node->data; }
+                pointer operator->() const { return &node->data; }
+                Iterator& operator++(){ node = before ? list->head : node->next; before = false; return *this; }
+                Iterator operator++(int){ Iterator it = *this; ++(*this); return it; }
+                bool operator==(const Iterator &other) const { return node == other.node && before == other.before; }
+                bool operator!=(const Iterator &other) const { return !(*this == other); }
+
+                friend class LinkedList;
+        };
+        typedef Iterator<T> iterator;
+        typedef Iterator<const T> const_iterator;
+
         LinkedList();                                       // empty constructor
         LinkedList(T);                                      // element constructor
+        template <typename It>
+        LinkedList(It, It);                                 // range constructor
         LinkedList(const LinkedList<T>&);                   // copy constructor
+        LinkedList(LinkedList<T>&&);                        // move constructor
+        ~LinkedList();                                      // destructor
         LinkedList<T>& operator=(const LinkedList<T>&);     // assignment operator
+        LinkedList<T>& operator=(LinkedList<T>&&);          // move assignment operator
         bool operator != (const LinkedList<T>&) const;      // not equal operator
         bool operator == (const LinkedList<T>&) const;      // is equal operator
         void print_list();                                  // list printer
@@ -52,6 +107,22 @@ class LinkedList {
         void bubble_sort();                                 // bubble sort list in place
         void selection_sort();                              // select sort list in place
         inline size_t size();
+
+        iterator before_begin(){ return iterator(nullptr, this, true); }
+        iterator begin(){ return iterator(head, this); }
+        iterator end(){ return iterator(nullptr, this); }
+        const_iterator before_begin() const { return const_iterator(nullptr, this, true); }
+        const_iterator begin() const { return const_iterator(head, this); }
+        const_iterator end() const { return const_iterator(nullptr, this); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        iterator insert_after(iterator, T);                 // insert after position
+        iterator erase_after(iterator);                     // erase element after position, returns next
+        void splice_after(iterator, LinkedList<T>&);        // move all of other after position
+        void splice_after(iterator, LinkedList<T>&, iterator); // move element after it in other after position
+        void concat(LinkedList<T>&);                        // move all of other to the end, O(1)
+        LinkedList<T> split_at(size_t);                     // hand off elements [i, size) as a new list
 };
 
 // empty constructor
@@ -70,79 +141,158 @@ LinkedList<T>::LinkedList(T a){
     num_nodes = 1;
 }
 
-// copy constructor
+// range constructor, copies [first, last) into a single pooled allocation
 template <typename T>
-LinkedList<T>::LinkedList(const LinkedList &other){
-    Node<T> *n, *p;
-
-    p = other.head;
+template <typename It>
+LinkedList<T>::LinkedList(It first, It last){
+    head = nullptr;
+    tail = nullptr;
     num_nodes = 0;
 
-    // assign head
-    if(p != nullptr) {
-        head = new Node<T>(p->data);
-        ++num_nodes;
-    } else {
-        head = nullptr;
+    // no destructor runs if this throws, free what was appended
+    try {
+        append_range(first, last);
+    } catch(...) {
+        clear();
+        throw;
     }
+}
 
-    n = head;
-
-    // assign body
-    while(p != nullptr){
-        p = p->next;
+// copy constructor
+template <typename T>
+LinkedList<T>::LinkedList(const LinkedList &other){
+    head = nullptr;
+    tail = nullptr;
+    num_nodes = 0;
 
-        // keep n for use w/ tail
-        if(p != nullptr){
-            ++num_nodes;
-            n->next = new Node<T>(p->data);
-            n = n->next;
-        }
+    try {
+        append_range(other.begin(), other.end());
+    } catch(...) {
+        clear();
+        throw;
     }
+}
 
-    // assign tail
-    tail = n;
+// move constructor, takes over other's nodes
+template <typename T>
+LinkedList<T>::LinkedList(LinkedList<T> &&other){
+    head = other.head;
+    tail = other.tail;
+    num_nodes = other.num_nodes;
+
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.num_nodes = 0;
+}
+
+// destructor
+template <typename T>
+LinkedList<T>::~LinkedList(){
+    clear();
 }
 
 // assignment
 template <typename T>
 LinkedList<T>& LinkedList<T>::operator=(const LinkedList<T> &other){
-    Node<T> *n, *p;
-
-    p = other.head;
-
     // detect self-assignment, prevent self-deletion
     if(this == &other)
         return *this;
 
     // if this LinkedList already has elements, clear the memory
-    if(head != nullptr && p != nullptr)
-        clear();
+    clear();
 
-    // assign head
-    if(p != nullptr) {
-        head = new Node<T>(p->data);
-        ++num_nodes;
-    }
+    append_range(other.begin(), other.end());
+
+    return *this;
+}
 
-    n = head;
+// move assignment
+template <typename T>
+LinkedList<T>& LinkedList<T>::operator=(LinkedList<T> &&other){
+    if(this == &other)
+        return *this;
 
-    // assign body
-    while(p != nullptr){
-        p = p->next;
+    clear();
 
-        // keep n for use w/ tail
-        if(p != nullptr){
+    head = other.head;
+    tail = other.tail;
+    num_nodes = other.num_nodes;
+
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.num_nodes = 0;
+
+    return *this;
+}
+
+template <typename T>
+template <typename It>
+void LinkedList<T>::append_range(It first, It last){
+    append_range(first, last, typename std::iterator_traits<It>::iterator_category());
+}
+
+// single pass, the length is unknown until the end, so one node at a time
+template <typename T>
+template <typename It>
+void LinkedList<T>::append_range(It first, It last, std::input_iterator_tag){
+    for(; first != last; ++first)
+        push_back(*first);
+}
+
+// appends copies of [first, last), all nodes placed in one NodeBlock
+template <typename T>
+template <typename It>
+void LinkedList<T>::append_range(It first, It last, std::forward_iterator_tag){
+    size_t count = std::distance(first, last);
+    size_t offset = (sizeof(NodeBlock) + alignof(Node<T>) - 1) / alignof(Node<T>) * alignof(Node<T>);
+    char *memory;
+    NodeBlock *block;
+    Node<T> *node;
+    size_t i = 0;
+
+    if(count == 0)
+        return;
+
+    memory = static_cast<char*>(::operator new(offset + count * sizeof(Node<T>)));
+    block = new (memory) NodeBlock();
+    block->live = 0;
+
+    try {
+        for(; first != last; ++first, ++i){
+            node = new (memory + offset + i * sizeof(Node<T>)) Node<T>(*first);
+            node->block = block;
+            ++block->live;
+
+            if(tail != nullptr)
+                tail->next = node;
+            else
+                head = node;
+            tail = node;
             ++num_nodes;
-            n->next = new Node<T>(p->data);
-            n = n->next;
         }
+    } catch(...) {
+        // nodes already linked release the block as they are destroyed
+        if(block->live == 0)
+            ::operator delete(memory);
+        throw;
     }
+}
 
-    // assign tail
-    tail = n;
+// frees a node, pooled nodes release their share of the block
+template <typename T>
+void LinkedList<T>::destroy_node(Node<T> *node){
+    NodeBlock *block = node->block;
 
-    return *this;
+    if(block == nullptr){
+        delete node;
+        return;
+    }
+
+    node->~Node<T>();
+    if(--block->live == 0){
+        block->~NodeBlock();
+        ::operator delete(static_cast<void*>(block));
+    }
 }
 
 template <typename T>
@@ -204,10 +354,13 @@ void LinkedList<T>::clear(){
 
     while(node != nullptr){
         node = node->next;
-        delete prev;
+        destroy_node(prev);
         prev = node;
-        --num_nodes;
     }
+
+    head = nullptr;
+    tail = nullptr;
+    num_nodes = 0;
 }
 
 template <typename T>
@@ -215,6 +368,11 @@ void LinkedList<T>::push_front(T data){
     Node<T> *node = new Node<T>(data);
     node->next = head;
     head = node;
+
+    // first element is also the tail
+    if(tail == nullptr)
+        tail = node;
+
     ++num_nodes;
 }
 
@@ -280,8 +438,12 @@ T LinkedList<T>::pop_front(){
         T data = head->data;
         Node<T> *node = head;
         head = head->next;
-    
-        delete node;
+
+        // popped the only element
+        if(head == nullptr)
+            tail = nullptr;
+
+        destroy_node(node);
         --num_nodes;
         return data;
     } else {
@@ -292,17 +454,24 @@ T LinkedList<T>::pop_front(){
 template <typename T>
 T LinkedList<T>::pop_back(){
     if(tail != nullptr){
-        T data;
-        int i = 1;
+        T data = tail->data;
         Node<T> *node = head;
-    
-        while(i++ < num_nodes-1)
+
+        // single element, list becomes empty
+        if(head == tail){
+            destroy_node(head);
+            head = nullptr;
+            tail = nullptr;
+            --num_nodes;
+            return data;
+        }
+
+        // walk to the second-to-last node, O(n) - see DoublyLinkedList for O(1)
+        while(node->next != tail)
             node = node->next;
-    
-        data = node->next->data;
+
+        destroy_node(tail);
         tail = node;
-    
-        delete node->next;
         tail->next = nullptr;
         --num_nodes;
         return data;
@@ -349,6 +518,164 @@ void LinkedList<T>::reverse(){
 template <typename T>
 inline size_t LinkedList<T>::size(){ return num_nodes; }
 
+// inserts data after pos, returns an iterator to the new element
+template <typename T>
+typename LinkedList<T>::iterator LinkedList<T>::insert_after(iterator pos, T data){
+    Node<T> *node;
+
+    if(pos.before){
+        push_front(data);
+        return begin();
+    }
+
+    if(pos.node == nullptr)
+        throw ZeroLengthException();
+
+    node = new Node<T>(data);
+    node->next = pos.node->next;
+    pos.node->next = node;
+
+    if(pos.node == tail)
+        tail = node;
+
+    ++num_nodes;
+    return iterator(node, this);
+}
+
+// erases the element following pos, returns an iterator to the element after it
+template <typename T>
+typename LinkedList<T>::iterator LinkedList<T>::erase_after(iterator pos){
+    Node<T> *prev = pos.before ? nullptr : pos.node;
+    Node<T> *node = pos.before ? head : (prev != nullptr ? prev->next : nullptr);
+
+    if(node == nullptr)
+        throw ZeroLengthException();
+
+    if(prev == nullptr)
+        head = node->next;
+    else
+        prev->next = node->next;
+
+    if(node == tail)
+        tail = prev;
+
+    --num_nodes;
+    prev = node->next;
+    destroy_node(node);
+    return iterator(prev, this);
+}
+
+// relinks every node of other after pos, other is left empty
+template <typename T>
+void LinkedList<T>::splice_after(iterator pos, LinkedList<T> &other){
+    if(this == &other || other.head == nullptr)
+        return;
+
+    if(pos.before){
+        other.tail->next = head;
+        head = other.head;
+        if(tail == nullptr)
+            tail = other.tail;
+    } else {
+        if(pos.node == nullptr)
+            throw ZeroLengthException();
+
+        other.tail->next = pos.node->next;
+        pos.node->next = other.head;
+        if(pos.node == tail)
+            tail = other.tail;
+    }
+
+    num_nodes += other.num_nodes;
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.num_nodes = 0;
+}
+
+// relinks the node following it (owned by other) after pos
+template <typename T>
+void LinkedList<T>::splice_after(iterator pos, LinkedList<T> &other, iterator it){
+    Node<T> *prev = it.before ? nullptr : it.node;
+    Node<T> *node = it.before ? other.head : (prev != nullptr ? prev->next : nullptr);
+
+    if(node == nullptr || node == pos.node)
+        return;
+
+    // nothing may be linked after end(), checked before other is touched
+    if(!pos.before && pos.node == nullptr)
+        throw ZeroLengthException();
+
+    // unlink from other
+    if(prev == nullptr)
+        other.head = node->next;
+    else
+        prev->next = node->next;
+    if(node == other.tail)
+        other.tail = prev;
+    --other.num_nodes;
+
+    // link into this
+    if(pos.before){
+        node->next = head;
+        head = node;
+        if(tail == nullptr)
+            tail = node;
+    } else {
+        node->next = pos.node->next;
+        pos.node->next = node;
+        if(pos.node == tail)
+            tail = node;
+    }
+    ++num_nodes;
+}
+
+// relinks every node of other onto the end of this list, other is left empty
+template <typename T>
+void LinkedList<T>::concat(LinkedList<T> &other){
+    if(this == &other || other.head == nullptr)
+        return;
+
+    if(tail != nullptr)
+        tail->next = other.head;
+    else
+        head = other.head;
+    tail = other.tail;
+    num_nodes += other.num_nodes;
+
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.num_nodes = 0;
+}
+
+// detaches the elements from index i onwards and returns them as a new list,
+// walks i nodes to find the split point but never copies an element
+template <typename T>
+LinkedList<T> LinkedList<T>::split_at(size_t i){
+    LinkedList<T> suffix;
+    Node<T> *prev = nullptr;
+
+    if(i >= num_nodes)
+        return suffix;
+
+    if(i == 0){
+        suffix.head = head;
+        head = nullptr;
+    } else {
+        prev = head;
+        for(size_t k = 1; k < i; ++k)
+            prev = prev->next;
+        suffix.head = prev->next;
+        prev->next = nullptr;
+    }
+
+    suffix.tail = tail;
+    suffix.num_nodes = num_nodes - i;
+    tail = prev;
+    num_nodes = i;
+
+    return suffix;
+}
+
 template <typename T>
 void LinkedList<T>::bubble_sort(){
     Node<T> *a, *b;
@@ -0,0 +1,394 @@
+// linked_list_bench.cpp
+// author:  Joseph Perry
+// desc:    Benchmarks LinkedList and DoublyLinkedList against std::list,
+//          std::forward_list and std::deque. Reports ns/op, heap allocations
+//          per op (counted by replacing the global operator new/delete) and
+//          cache misses per op where the kernel exposes perf counters.
+//
+//          usage: ./linked_list_bench [max_size] [quadratic_limit]
+//          sizes run from 10 to max_size (default 10^7) in powers of 10,
+//          operations that are O(n) per element for a container (LinkedList
+//          pop_back, bubble/selection sort) stop at quadratic_limit (default 10^4)
+
+#include "linked_list.h"
+#include "doubly_linked_list.h"
+#include <list>
+#include <forward_list>
+#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+using namespace std;
+
+// interposed allocator, every heap allocation in the process is counted.
+// kept out of line so the compiler never pairs an inlined malloc()/free()
+// with a new/delete expression and warns about a mismatch
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+static size_t num_allocs = 0;
+
+BENCH_NOINLINE void* operator new(size_t size){
+    void *p = malloc(size == 0 ? 1 : size);
+
+    if(p == nullptr)
+        throw bad_alloc();
+    ++num_allocs;
+    return p;
+}
+
+void* operator new[](size_t size){ return operator new(size); }
+BENCH_NOINLINE void operator delete(void *p) noexcept { free(p); }
+BENCH_NOINLINE void operator delete[](void *p) noexcept { free(p); }
+BENCH_NOINLINE void operator delete(void *p, size_t) noexcept { free(p); }
+BENCH_NOINLINE void operator delete[](void *p, size_t) noexcept { free(p); }
+
+// hardware cache-miss counter for this thread, unavailable -> valid() is false
+class CacheMissCounter {
+    private:
+        int fd;
+    public:
+        CacheMissCounter() : fd(-1) {
+#ifdef __linux__
+            struct perf_event_attr attr;
+
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+        }
+        ~CacheMissCounter(){
+#ifdef __linux__
+            if(fd >= 0)
+                close(fd);
+#endif
+        }
+        bool valid() const { return fd >= 0; }
+        void start(){
+#ifdef __linux__
+            if(fd >= 0){
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+        long long stop(){
+            long long count = 0;
+#ifdef __linux__
+            if(fd >= 0){
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                if(read(fd, &count, sizeof(count)) != sizeof(count))
+                    count = 0;
+            }
+#endif
+            return count;
+        }
+};
+
+static CacheMissCounter cache_misses;
+
+// keeps results observable so the optimizer cannot drop the work
+static volatile size_t sink = 0;
+
+// runs f once and prints one result row, ops is the number of operations f performed
+template <typename F>
+void measure(const char *container, const char *type, const char *op, size_t n, size_t ops, F f){
+    size_t allocs;
+    long long misses;
+    chrono::steady_clock::time_point start, stop;
+    double ns;
+
+    allocs = num_allocs;
+    cache_misses.start();
+    start = chrono::steady_clock::now();
+
+    f();
+
+    stop = chrono::steady_clock::now();
+    misses = cache_misses.stop();
+    allocs = num_allocs - allocs;
+    ns = chrono::duration<double, nano>(stop - start).count();
+
+    printf("%-18s %-7s %-11s %9zu %12.1f %10.3f ", container, type, op, n, ns / ops, (double)allocs / ops);
+    if(cache_misses.valid())
+        printf("%10.3f\n", (double)misses / ops);
+    else
+        printf("%10s\n", "n/a");
+}
+
+void skipped(const char *container, const char *type, const char *op, size_t n){
+    printf("%-18s %-7s %-11s %9zu %12s %10s %10s\n", container, type, op, n, "skipped", "-", "-");
+}
+
+// test values, strings are long enough to defeat the small string optimization
+template <typename T> T make_value(size_t);
+template <> int make_value<int>(size_t i){ return (int)i; }
+template <> string make_value<string>(size_t i){ return "linked_list_bench_value_" + to_string(i); }
+
+template <typename T> const char* type_name();
+template <> const char* type_name<int>(){ return "int"; }
+template <> const char* type_name<string>(){ return "string"; }
+
+// container adapters giving every container the same operations
+template <typename C> struct Ops;
+
+template <typename T>
+struct Ops<LinkedList<T>> {
+    static const char* name(){ return "LinkedList"; }
+    static const bool has_push_back = true;
+    static const bool constant_pop_back = false;
+    static const bool fast_sort = false;
+    static void push_back(LinkedList<T> &c, const T &v){ c.push_back(v); }
+    static void push_front(LinkedList<T> &c, const T &v){ c.push_front(v); }
+    static void pop_back(LinkedList<T> &c){ c.pop_back(); }
+    static void pop_front(LinkedList<T> &c){ c.pop_front(); }
+    static bool find(LinkedList<T> &c, const T &v){
+        try { c.find_first(v); return true; } catch(ZeroLengthException &e) { return false; }
+    }
+    static void reverse(LinkedList<T> &c){ c.reverse(); }
+    static void sort(LinkedList<T> &c){ c.selection_sort(); }
+};
+
+template <typename T>
+struct Ops<DoublyLinkedList<T>> {
+    static const char* name(){ return "DoublyLinkedList"; }
+    static const bool has_push_back = true;
+    static const bool constant_pop_back = true;
+    static const bool fast_sort = true;
+    static void push_back(DoublyLinkedList<T> &c, const T &v){ c.push_back(v); }
+    static void push_front(DoublyLinkedList<T> &c, const T &v){ c.push_front(v); }
+    static void pop_back(DoublyLinkedList<T> &c){ c.pop_back(); }
+    static void pop_front(DoublyLinkedList<T> &c){ c.pop_front(); }
+    static bool find(DoublyLinkedList<T> &c, const T &v){
+        try { c.find_first(v); return true; } catch(ZeroLengthException &e) { return false; }
+    }
+    static void reverse(DoublyLinkedList<T> &c){ c.reverse(); }
+    // no sort member, sort the values in place through the iterators
+    static void sort(DoublyLinkedList<T> &c){
+        vector<T> v(c.begin(), c.end());
+        std::sort(v.begin(), v.end());
+        std::copy(v.begin(), v.end(), c.begin());
+    }
+};
+
+template <typename T>
+struct Ops<list<T>> {
+    static const char* name(){ return "std::list"; }
+    static const bool has_push_back = true;
+    static const bool constant_pop_back = true;
+    static const bool fast_sort = true;
+    static void push_back(list<T> &c, const T &v){ c.push_back(v); }
+    static void push_front(list<T> &c, const T &v){ c.push_front(v); }
+    static void pop_back(list<T> &c){ c.pop_back(); }
+    static void pop_front(list<T> &c){ c.pop_front(); }
+    static bool find(list<T> &c, const T &v){ return std::find(c.begin(), c.end(), v) != c.end(); }
+    static void reverse(list<T> &c){ c.reverse(); }
+    static void sort(list<T> &c){ c.sort(); }
+};
+
+template <typename T>
+struct Ops<forward_list<T>> {
+    static const char* name(){ return "std::forward_list"; }
+    static const bool has_push_back = false;
+    static const bool constant_pop_back = false;
+    static const bool fast_sort = true;
+    static void push_back(forward_list<T>&, const T&){}
+    static void push_front(forward_list<T> &c, const T &v){ c.push_front(v); }
+    static void pop_back(forward_list<T>&){}
+    static void pop_front(forward_list<T> &c){ c.pop_front(); }
+    static bool find(forward_list<T> &c, const T &v){ return std::find(c.begin(), c.end(), v) != c.end(); }
+    static void reverse(forward_list<T> &c){ c.reverse(); }
+    static void sort(forward_list<T> &c){ c.sort(); }
+};
+
+template <typename T>
+struct Ops<deque<T>> {
+    static const char* name(){ return "std::deque"; }
+    static const bool has_push_back = true;
+    static const bool constant_pop_back = true;
+    static const bool fast_sort = true;
+    static void push_back(deque<T> &c, const T &v){ c.push_back(v); }
+    static void push_front(deque<T> &c, const T &v){ c.push_front(v); }
+    static void pop_back(deque<T> &c){ c.pop_back(); }
+    static void pop_front(deque<T> &c){ c.pop_front(); }
+    static bool find(deque<T> &c, const T &v){ return std::find(c.begin(), c.end(), v) != c.end(); }
+    static void reverse(deque<T> &c){ std::reverse(c.begin(), c.end()); }
+    static void sort(deque<T> &c){ std::sort(c.begin(), c.end()); }
+};
+
+// fills c with n values, in order or shuffled
+template <typename C, typename T>
+void fill(C &c, const vector<T> &values){
+    for(typename vector<T>::const_reverse_iterator it = values.rbegin(); it != values.rend(); ++it)
+        Ops<C>::push_front(c, *it);
+}
+
+// repeat operations so small sizes still take measurable time, ~10^6 elements per row
+size_t repetitions(size_t n){
+    size_t reps = 1000000 / n;
+
+    return reps < 1 ? 1 : reps;
+}
+
+template <typename C, typename T>
+void bench_container(size_t n, size_t quadratic_limit){
+    typedef Ops<C> O;
+    const char *name = O::name();
+    const char *type = type_name<T>();
+    vector<T> values, shuffled;
+    size_t reps = repetitions(n);
+
+    for(size_t i = 0; i < n; ++i)
+        values.push_back(make_value<T>(i));
+    shuffled = values;
+    shuffle(shuffled.begin(), shuffled.end(), mt19937(42));
+
+    // element operations run on `reps` containers so small sizes are measurable
+    if(O::has_push_back){
+        vector<C> c(reps);
+        measure(name, type, "push_back", n, n * reps, [&](){
+            for(size_t r = 0; r < reps; ++r)
+                for(size_t i = 0; i < n; ++i)
+                    O::push_back(c[r], values[i]);
+        });
+    }
+
+    {
+        vector<C> c(reps);
+        measure(name, type, "push_front", n, n * reps, [&](){
+            for(size_t r = 0; r < reps; ++r)
+                for(size_t i = 0; i < n; ++i)
+                    O::push_front(c[r], values[i]);
+        });
+    }
+
+    {
+        vector<C> c(reps);
+        for(size_t r = 0; r < reps; ++r)
+            fill(c[r], values);
+        measure(name, type, "pop_front", n, n * reps, [&](){
+            for(size_t r = 0; r < reps; ++r)
+                for(size_t i = 0; i < n; ++i)
+                    O::pop_front(c[r]);
+        });
+    }
+
+    if(O::has_push_back){
+        if(O::constant_pop_back || n <= quadratic_limit){
+            vector<C> c(reps);
+            for(size_t r = 0; r < reps; ++r)
+                fill(c[r], values);
+            measure(name, type, "pop_back", n, n * reps, [&](){
+                for(size_t r = 0; r < reps; ++r)
+                    for(size_t i = 0; i < n; ++i)
+                        O::pop_back(c[r]);
+            });
+        } else {
+            skipped(name, type, "pop_back", n);
+        }
+    }
+
+    {
+        C c;
+        fill(c, values);
+
+        // worst case, the searched value is last
+        measure(name, type, "find", n, reps, [&](){
+            for(size_t r = 0; r < reps; ++r)
+                sink = sink + O::find(c, values[n - 1]);
+        });
+
+        {
+            C copy(c);
+            measure(name, type, "equality", n, reps, [&](){
+                for(size_t r = 0; r < reps; ++r)
+                    sink = sink + (c == copy);
+            });
+        }
+
+        measure(name, type, "reverse", n, reps, [&](){
+            for(size_t r = 0; r < reps; ++r)
+                O::reverse(c);
+        });
+
+        measure(name, type, "copy", n, reps, [&](){
+            for(size_t r = 0; r < reps; ++r){
+                C copy(c);
+                sink = sink + (size_t)&copy;
+            }
+        });
+    }
+
+    if(O::fast_sort || n <= quadratic_limit){
+        size_t sort_reps = repetitions(n * 100);
+        vector<C> c(sort_reps);
+        for(size_t r = 0; r < sort_reps; ++r)
+            fill(c[r], shuffled);
+        measure(name, type, "sort", n, sort_reps, [&](){
+            for(size_t r = 0; r < sort_reps; ++r)
+                O::sort(c[r]);
+        });
+    } else {
+        skipped(name, type, "sort", n);
+    }
+}
+
+template <typename T>
+void bench_type(size_t n, size_t quadratic_limit){
+    bench_container<LinkedList<T>, T>(n, quadratic_limit);
+    bench_container<DoublyLinkedList<T>, T>(n, quadratic_limit);
+    bench_container<list<T>, T>(n, quadratic_limit);
+    bench_container<forward_list<T>, T>(n, quadratic_limit);
+    bench_container<deque<T>, T>(n, quadratic_limit);
+}
+
+int main(int argc, char *argv[]){
+    size_t max_size = 10000000;
+    size_t quadratic_limit = 10000;
+
+    if(argc > 1){
+        istringstream ss(argv[1]);
+        if(!(ss >> max_size)){
+            cerr << "Invalid max_size : " << argv[1] << endl;
+            return 1;
+        }
+    }
+    if(argc > 2){
+        istringstream ss(argv[2]);
+        if(!(ss >> quadratic_limit)){
+            cerr << "Invalid quadratic_limit : " << argv[2] << endl;
+            return 1;
+        }
+    }
+
+    printf("%-18s %-7s %-11s %9s %12s %10s %10s\n", "container", "type", "op", "n", "ns/op", "allocs/op", "misses/op");
+
+    for(size_t n = 10; n <= max_size; n *= 10){
+        bench_type<int>(n, quadratic_limit);
+        bench_type<string>(n, quadratic_limit);
+    }
+
+    return 0;
+}
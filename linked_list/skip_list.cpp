@@ -0,0 +1,59 @@
+// skip_list.cpp
+// author:  Joseph Perry
+// desc:    An example of how to use the SkipList and ConcurrentSkipList classes defined in skip_list.h
+
+#include "skip_list.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int main(){
+    SkipList<int> set;
+    ConcurrentSkipList<int> shared;
+    vector<thread> threads;
+    int num_threads = 4;
+    int per_thread = 10000;
+
+    for(int i : { 7, 3, 9, 1, 5, 3, 8 })
+        set.push(i);
+
+    set.print_list();
+    cout << set.size() << " " << set.contains(5) << " " << set.find(9) << endl;
+
+    set.erase(5);
+    set.range(2, 8).print_list();
+    cout << *set.lower_bound(4) << endl;
+
+    try{
+        set.find(5);
+    } catch(ZeroLengthException &e) {
+        cout << e.what() << endl;
+    }
+
+    // writers insert interleaved values while readers look them up
+    for(int t = 0; t < num_threads; ++t)
+        threads.push_back(thread([&shared, t, num_threads, per_thread](){
+            for(int i = 0; i < per_thread; ++i)
+                shared.push(i * num_threads + t);
+        }));
+    for(int t = 0; t < num_threads; ++t)
+        threads.push_back(thread([&shared, per_thread](){
+            int found = 0;
+            for(int i = 0; i < per_thread; ++i)
+                found += shared.contains(i);
+            (void)found;
+        }));
+    for(auto &th : threads)
+        th.join();
+
+    cout << shared.size() << endl;
+
+    for(int i = 0; i < 40; i += 2)
+        shared.erase(i);
+    shared.compact();
+    shared.range(0, 20).print_list();
+
+    return 0;
+}
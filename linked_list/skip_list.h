@@ -0,0 +1,492 @@
+// skip_list.h
+// author:  Joseph Perry
+// desc:    This file defines an ordered SkipList set with expected O(log n)
+//          push/find/erase and range scans, and a ConcurrentSkipList whose
+//          push/find are lock-free for multi-threaded readers and writers.
+
+#ifndef SKIP_LIST_H
+#define SKIP_LIST_H
+
+#include <iostream>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include <atomic>
+#include <random>
+#include "linked_list.h"
+
+// maximum tower height, enough for ~2^32 elements at p = 1/2
+const int SKIP_LIST_MAX_LEVEL = 32;
+
+// draws a tower height from a geometric distribution with p = 1/2
+inline int skip_list_random_level(){
+    static thread_local std::mt19937 rng(std::random_device{}());
+    unsigned int bits = rng();
+    int level = 1;
+
+    while((bits & 1) && level < SKIP_LIST_MAX_LEVEL){
+        bits >>= 1;
+        ++level;
+    }
+
+    return level;
+}
+
+template <typename T>
+class SkipList {
+    private:
+        class Node {
+            private:
+                T data;
+                std::vector<Node*> next;
+            public:
+                Node(T data, int level) : data(data), next(level, nullptr) {}
+                friend class SkipList;
+        };
+        Node *head[SKIP_LIST_MAX_LEVEL];
+        int level;
+        size_t num_nodes;
+
+        Node* find_preds(const T&, Node**);                 // fills update[] with the predecessor at each level
+
+    public:
+        // forward iterator walking the bottom level in order
+        class const_iterator {
+            private:
+                Node *node;
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const T* pointer;
+                typedef const T& reference;
+
+                const_iterator(Node *node = nullptr) : node(node) {}
+
+                reference operator*() const { return node->data; }
+                pointer operator->() const { return &node->data; }
+                const_iterator& operator++(){ node = node->next[0]; return *this; }
+                const_iterator operator++(int){ const_iterator it = *this; node = node->next[0]; return it; }
+                bool operator==(const const_iterator &other) const { return node == other.node; }
+                bool operator!=(const const_iterator &other) const { return node != other.node; }
+        };
+        typedef const_iterator iterator;
+
+        SkipList();                                         // empty constructor
+        SkipList(const SkipList<T>&);                       // copy constructor
+        ~SkipList();                                        // destructor
+        SkipList<T>& operator=(const SkipList<T>&);         // assignment operator
+        bool push(T);                                       // insert, false if already present
+        bool erase(T);                                      // remove, false if not present
+        bool contains(T);                                   // membership test
+        T find(T);                                          // return the stored element equal to item
+        LinkedList<T> range(T, T);                          // elements in [lo, hi] in order
+        const_iterator lower_bound(T);                      // first element not less than item
+        void print_list();                                  // list printer
+        void clear();                                       // clear all elements
+        inline size_t size();
+
+        const_iterator begin() const { return const_iterator(head[0]); }
+        const_iterator end() const { return const_iterator(nullptr); }
+};
+
+// empty constructor
+template <typename T>
+SkipList<T>::SkipList(){
+    for(int i = 0; i < SKIP_LIST_MAX_LEVEL; ++i)
+        head[i] = nullptr;
+    level = 1;
+    num_nodes = 0;
+}
+
+// copy constructor
+template <typename T>
+SkipList<T>::SkipList(const SkipList<T> &other) : SkipList() {
+    for(Node *p = other.head[0]; p != nullptr; p = p->next[0])
+        push(p->data);
+}
+
+// destructor
+template <typename T>
+SkipList<T>::~SkipList(){
+    clear();
+}
+
+// assignment
+template <typename T>
+SkipList<T>& SkipList<T>::operator=(const SkipList<T> &other){
+    // detect self-assignment, prevent self-deletion
+    if(this == &other)
+        return *this;
+
+    clear();
+
+    for(Node *p = other.head[0]; p != nullptr; p = p->next[0])
+        push(p->data);
+
+    return *this;
+}
+
+// descends the towers, recording the last node before item at each level
+// (nullptr means the head) and returns the bottom-level successor
+template <typename T>
+typename SkipList<T>::Node* SkipList<T>::find_preds(const T &a, Node **update){
+    Node *p = nullptr;
+    Node *n;
+
+    for(int i = level - 1; i >= 0; --i){
+        n = (p == nullptr) ? head[i] : p->next[i];
+        while(n != nullptr && n->data < a){
+            p = n;
+            n = n->next[i];
+        }
+        update[i] = p;
+    }
+
+    return (p == nullptr) ? head[0] : p->next[0];
+}
+
+template <typename T>
+bool SkipList<T>::push(T a){
+    Node *update[SKIP_LIST_MAX_LEVEL];
+    Node *n = find_preds(a, update);
+    int new_level;
+
+    if(n != nullptr && n->data == a)
+        return false;
+
+    new_level = skip_list_random_level();
+    for(int i = level; i < new_level; ++i)
+        update[i] = nullptr;
+    if(new_level > level)
+        level = new_level;
+
+    n = new Node(a, new_level);
+    for(int i = 0; i < new_level; ++i){
+        Node *&link = (update[i] == nullptr) ? head[i] : update[i]->next[i];
+        n->next[i] = link;
+        link = n;
+    }
+
+    ++num_nodes;
+    return true;
+}
+
+template <typename T>
+bool SkipList<T>::erase(T a){
+    Node *update[SKIP_LIST_MAX_LEVEL];
+    Node *n = find_preds(a, update);
+
+    if(n == nullptr || !(n->data == a))
+        return false;
+
+    for(int i = 0; i < (int)n->next.size(); ++i){
+        Node *&link = (update[i] == nullptr) ? head[i] : update[i]->next[i];
+        link = n->next[i];
+    }
+
+    while(level > 1 && head[level - 1] == nullptr)
+        --level;
+
+    delete n;
+    --num_nodes;
+    return true;
+}
+
+template <typename T>
+bool SkipList<T>::contains(T a){
+    Node *update[SKIP_LIST_MAX_LEVEL];
+    Node *n = find_preds(a, update);
+
+    return n != nullptr && n->data == a;
+}
+
+template <typename T>
+T SkipList<T>::find(T a){
+    Node *update[SKIP_LIST_MAX_LEVEL];
+    Node *n = find_preds(a, update);
+
+    if(n != nullptr && n->data == a)
+        return n->data;
+    else
+        throw ZeroLengthException();
+}
+
+template <typename T>
+typename SkipList<T>::const_iterator SkipList<T>::lower_bound(T a){
+    Node *update[SKIP_LIST_MAX_LEVEL];
+
+    return const_iterator(find_preds(a, update));
+}
+
+template <typename T>
+LinkedList<T> SkipList<T>::range(T lo, T hi){
+    LinkedList<T> result;
+
+    for(const_iterator it = lower_bound(lo); it != end() && !(hi < *it); ++it)
+        result.push_back(*it);
+
+    return result;
+}
+
+template <typename T>
+void SkipList<T>::print_list(){
+    Node *p = head[0];
+
+    if(p != nullptr)
+        while(p != nullptr){
+            std::cout << p->data << " ";
+            p = p->next[0];
+        }
+    else
+        std::cout << "Empty list";
+    std::cout << std::endl;
+}
+
+template <typename T>
+void SkipList<T>::clear(){
+    Node *node = head[0];
+    Node *prev = node;
+
+    while(node != nullptr){
+        node = node->next[0];
+        delete prev;
+        prev = node;
+    }
+
+    for(int i = 0; i < SKIP_LIST_MAX_LEVEL; ++i)
+        head[i] = nullptr;
+    level = 1;
+    num_nodes = 0;
+}
+
+template <typename T>
+inline size_t SkipList<T>::size(){ return num_nodes; }
+
+// Lock-free ordered set. push/contains/find/range may run from any number of
+// threads at once. Nodes are never unlinked while the list is shared: erase
+// only marks a node deleted (a later push of the same value revives it), and
+// memory is reclaimed by compact() or the destructor once threads are done.
+template <typename T>
+class ConcurrentSkipList {
+    private:
+        class Node {
+            private:
+                T data;
+                int level;
+                std::atomic<bool> deleted;
+                std::atomic<Node*> *next;
+            public:
+                Node(T data, int level) : data(data), level(level), deleted(false), next(new std::atomic<Node*>[level]) {
+                    for(int i = 0; i < level; ++i)
+                        next[i].store(nullptr, std::memory_order_relaxed);
+                }
+                ~Node(){ delete[] next; }
+                friend class ConcurrentSkipList;
+        };
+        // sentinel links, head[i] plays the role of a node's next[i]
+        std::atomic<Node*> head[SKIP_LIST_MAX_LEVEL];
+        std::atomic<size_t> num_nodes;
+
+        std::atomic<Node*>& link(Node *p, int i){ return (p == nullptr) ? head[i] : p->next[i]; }
+        Node* find_preds(const T&, Node**, Node**);         // fills preds/succs at every level
+
+    public:
+        ConcurrentSkipList();                               // empty constructor
+        ConcurrentSkipList(const ConcurrentSkipList<T>&) = delete;
+        ConcurrentSkipList<T>& operator=(const ConcurrentSkipList<T>&) = delete;
+        ~ConcurrentSkipList();                              // destructor
+        bool push(T);                                       // lock-free insert, false if already present
+        bool erase(T);                                      // logical delete, false if not present
+        bool contains(T);                                   // lock-free membership test
+        T find(T);                                          // return the stored element equal to item
+        LinkedList<T> range(T, T);                          // weakly consistent scan of [lo, hi]
+        void compact();                                     // unlink erased nodes, not thread-safe
+        void print_list();                                  // list printer
+        inline size_t size();
+};
+
+// empty constructor
+template <typename T>
+ConcurrentSkipList<T>::ConcurrentSkipList(){
+    for(int i = 0; i < SKIP_LIST_MAX_LEVEL; ++i)
+        head[i].store(nullptr, std::memory_order_relaxed);
+    num_nodes.store(0, std::memory_order_relaxed);
+}
+
+// destructor
+template <typename T>
+ConcurrentSkipList<T>::~ConcurrentSkipList(){
+    Node *node = head[0].load(std::memory_order_relaxed);
+    Node *prev = node;
+
+    while(node != nullptr){
+        node = node->next[0].load(std::memory_order_relaxed);
+        delete prev;
+        prev = node;
+    }
+}
+
+// returns the bottom-level successor, which is the match if one exists
+template <typename T>
+typename ConcurrentSkipList<T>::Node* ConcurrentSkipList<T>::find_preds(const T &a, Node **preds, Node **succs){
+    Node *p = nullptr;
+    Node *n;
+
+    for(int i = SKIP_LIST_MAX_LEVEL - 1; i >= 0; --i){
+        n = link(p, i).load(std::memory_order_acquire);
+        while(n != nullptr && n->data < a){
+            p = n;
+            n = n->next[i].load(std::memory_order_acquire);
+        }
+        preds[i] = p;
+        succs[i] = n;
+    }
+
+    return succs[0];
+}
+
+template <typename T>
+bool ConcurrentSkipList<T>::push(T a){
+    Node *preds[SKIP_LIST_MAX_LEVEL];
+    Node *succs[SKIP_LIST_MAX_LEVEL];
+    Node *node = nullptr;
+    Node *n;
+    bool expected;
+
+    while(true){
+        n = find_preds(a, preds, succs);
+
+        // already present, revive it if it was erased
+        if(n != nullptr && n->data == a){
+            delete node;
+            expected = true;
+            if(n->deleted.compare_exchange_strong(expected, false, std::memory_order_acq_rel)){
+                num_nodes.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        if(node == nullptr)
+            node = new Node(a, skip_list_random_level());
+
+        // the bottom level decides membership, retry from scratch if we lost the race
+        node->next[0].store(succs[0], std::memory_order_relaxed);
+        if(link(preds[0], 0).compare_exchange_strong(succs[0], node, std::memory_order_release, std::memory_order_relaxed))
+            break;
+    }
+
+    num_nodes.fetch_add(1, std::memory_order_relaxed);
+
+    // upper levels are only shortcuts, relink them one at a time
+    for(int i = 1; i < node->level; ++i){
+        while(true){
+            node->next[i].store(succs[i], std::memory_order_relaxed);
+            if(link(preds[i], i).compare_exchange_strong(succs[i], node, std::memory_order_release, std::memory_order_relaxed))
+                break;
+            find_preds(a, preds, succs);
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+bool ConcurrentSkipList<T>::erase(T a){
+    Node *preds[SKIP_LIST_MAX_LEVEL];
+    Node *succs[SKIP_LIST_MAX_LEVEL];
+    Node *n = find_preds(a, preds, succs);
+    bool expected = false;
+
+    if(n == nullptr || !(n->data == a))
+        return false;
+
+    if(!n->deleted.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return false;
+
+    num_nodes.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+template <typename T>
+bool ConcurrentSkipList<T>::contains(T a){
+    Node *preds[SKIP_LIST_MAX_LEVEL];
+    Node *succs[SKIP_LIST_MAX_LEVEL];
+    Node *n = find_preds(a, preds, succs);
+
+    return n != nullptr && n->data == a && !n->deleted.load(std::memory_order_acquire);
+}
+
+template <typename T>
+T ConcurrentSkipList<T>::find(T a){
+    Node *preds[SKIP_LIST_MAX_LEVEL];
+    Node *succs[SKIP_LIST_MAX_LEVEL];
+    Node *n = find_preds(a, preds, succs);
+
+    if(n != nullptr && n->data == a && !n->deleted.load(std::memory_order_acquire))
+        return n->data;
+    else
+        throw ZeroLengthException();
+}
+
+template <typename T>
+LinkedList<T> ConcurrentSkipList<T>::range(T lo, T hi){
+    Node *preds[SKIP_LIST_MAX_LEVEL];
+    Node *succs[SKIP_LIST_MAX_LEVEL];
+    LinkedList<T> result;
+    Node *n = find_preds(lo, preds, succs);
+
+    while(n != nullptr && !(hi < n->data)){
+        if(!n->deleted.load(std::memory_order_acquire))
+            result.push_back(n->data);
+        n = n->next[0].load(std::memory_order_acquire);
+    }
+
+    return result;
+}
+
+// physically removes erased nodes, callers must ensure no other thread is using the list
+template <typename T>
+void ConcurrentSkipList<T>::compact(){
+    Node *preds[SKIP_LIST_MAX_LEVEL];
+    Node *n = head[0].load(std::memory_order_relaxed);
+    Node *next;
+
+    for(int i = 0; i < SKIP_LIST_MAX_LEVEL; ++i)
+        preds[i] = nullptr;
+
+    while(n != nullptr){
+        next = n->next[0].load(std::memory_order_relaxed);
+
+        for(int i = 0; i < n->level; ++i){
+            if(n->deleted.load(std::memory_order_relaxed))
+                link(preds[i], i).store(n->next[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            else
+                preds[i] = n;
+        }
+
+        if(n->deleted.load(std::memory_order_relaxed))
+            delete n;
+        n = next;
+    }
+}
+
+template <typename T>
+void ConcurrentSkipList<T>::print_list(){
+    Node *p = head[0].load(std::memory_order_acquire);
+
+    if(size() == 0)
+        std::cout << "Empty list";
+    while(p != nullptr){
+        if(!p->deleted.load(std::memory_order_acquire))
+            std::cout << p->data << " ";
+        p = p->next[0].load(std::memory_order_acquire);
+    }
+    std::cout << std::endl;
+}
+
+template <typename T>
+inline size_t ConcurrentSkipList<T>::size(){ return num_nodes.load(std::memory_order_relaxed); }
+
+#endif
@@ -1,30 +1,54 @@
 #include "smoker.h"
 
-int main() {
+// Runs forever by default. With --rounds or --seconds the merchant stops after
+// that many handoffs or that much time, the table is closed and a report of
+// throughput, smokes per smoker, fairness and wait latency is printed.
+// --contention adds per-site lock statistics, --trace writes the events to a
+// binary trace instead of the console, with or without --quiet.
+int main(int argc, char *argv[]) {
 	std::map<Item, int> items = { { Item::Paper, 0 },
 								{ Item::Tobacco, 0 },
 								{ Item::Lighter, 0 } };
+	RunConfig config;
 
-	Smoker paper = Smoker(Item::Paper, items);
-	Smoker tobacco = Smoker(Item::Tobacco, items);
-	Smoker lighter = Smoker(Item::Lighter, items);
-	Merchant merchant = Merchant();
+	if(!parse_run_config(argc, argv, config))
+		return 1;
+
+	// events go to a binary trace instead of the console
+	std::unique_ptr<EventTrace> trace;
+	if(!open_event_trace(config, trace))
+		return 1;
+
+	// report lock contention at exit, and dump it on SIGUSR1 while running
+	std::unique_ptr<ContentionDumper> dumper;
+	if(config.contention){
+		ContentionSite::enable();
+		dumper.reset(new ContentionDumper(SIGUSR1));
+	}
+
+	Smoker paper = Smoker(Item::Paper, items, config);
+	Smoker tobacco = Smoker(Item::Tobacco, items, config);
+	Smoker lighter = Smoker(Item::Lighter, items, config);
+	Merchant merchant = Merchant(config);
+	Smoker::open();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
 	std::thread paper_thread([&paper, &items](){
-		while(true)
-			paper.can_smoke(items);
+		while(paper.can_smoke(items));
 	});
 	std::thread tobacco_thread([&tobacco, &items](){
-		while(true)
-			tobacco.can_smoke(items);
+		while(tobacco.can_smoke(items));
 	});
 	std::thread lighter_thread([&lighter, &items](){
-		while(true)
-			lighter.can_smoke(items);
+		while(lighter.can_smoke(items));
 	});
-	std::thread merchant_thread([&merchant, &items](){
-		while(true)
+	std::thread merchant_thread([&merchant, &items, &config, start](){
+		for(long round = 0; config.rounds == 0 || round < config.rounds; ++round){
+			if(config.duration.count() > 0 && std::chrono::steady_clock::now() - start >= config.duration)
+				break;
 			merchant.can_produce(items);
+		}
+		Smoker::close();
 	});
 
 	paper_thread.join();
@@ -32,5 +56,13 @@ int main() {
 	lighter_thread.join();
 	merchant_thread.join();
 
+	if(config.verbose)
+		flush_events();
+	print_run_report(std::cout, "smokes", std::chrono::steady_clock::now() - start,
+					 { paper.smokes(), tobacco.smokes(), lighter.smokes() },
+					 { paper.waits(), tobacco.waits(), lighter.waits() });
+	if(config.contention)
+		print_contention_report(std::cout);
+
 	return 0;
-}
\ No newline at end of file
+}
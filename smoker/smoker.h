@@ -13,6 +13,10 @@
 #include <list>
 #include <random>
 #include <chrono>
+#include "../concurrency/run_config.h"
+#include "../concurrency/run_stats.h"
+#include "../concurrency/contention.h"
+#include "../concurrency/event_log.h"
 
 // State and Inventory Enums
 enum class Merchant_state : int { Waiting, Producing };
@@ -32,15 +36,29 @@ void print_inventory(std::map<Item, int> items){
 class Smoker {
   public:
     // constructor function
-    Smoker(Item, std::map<Item, int>);
+    Smoker(Item, std::map<Item, int>, RunConfig = RunConfig());
 
-    // main loop
-    void can_smoke(std::map<Item, int> &);
+    // main loop, returns false once the table is closed and empty
+    bool can_smoke(std::map<Item, int> &);
+
+    // no more items will be produced, wakes every waiting smoker
+    static void close();
+
+    // reopen the table for another run
+    static void open();
+
+    // getter for the number of times this smoker has smoked
+    int inline smokes(){ return num_smokes; }
+
+    // getter for the time spent waiting for items on each round
+    const LatencyHistogram& waits(){ return wait_times; }
 
   private:
     Smoker_state state;
     Item item, prev, next;
     std::map<Item, int> inventory;
+    RunConfig options;
+    LatencyHistogram wait_times;
     int num_smokes;
     int id;
 
@@ -56,6 +74,8 @@ class Smoker {
     // shared class locking mechanisms
     static std::mutex mtx;
     static std::condition_variable cv;
+    static bool closed;
+    static ContentionSite site;
 
     // Merchant can access mtx and cv
     friend class Merchant;
@@ -64,9 +84,11 @@ class Smoker {
 // declaration of shared class locking mechanisms
 std::mutex Smoker::mtx;
 std::condition_variable Smoker::cv;
+bool Smoker::closed = false;
+ContentionSite Smoker::site("smoker table (smokers)");
 
 // constructor
-Smoker::Smoker(Item item, std::map<Item, int> inventory) : item(item), inventory(inventory), state(Smoker_state::Waiting){
+Smoker::Smoker(Item item, std::map<Item, int> inventory, RunConfig options) : state(Smoker_state::Waiting), item(item), inventory(inventory), options(options){
 
   inventory[item] = 1;
 
@@ -90,13 +112,17 @@ Smoker::Smoker(Item item, std::map<Item, int> inventory) : item(item), inventory
 }
 
 // concurrent main loop, contains critical section
-void Smoker::can_smoke(std::map<Item, int> &items){
-  std::unique_lock<std::mutex> lck(Smoker::mtx);
+bool Smoker::can_smoke(std::map<Item, int> &items){
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  ContendedLock lck(Smoker::mtx, Smoker::site);
 
   // wait for items
-  while(items[prev] <= 0 || items[next] <= 0){
-    Smoker::cv.wait(lck);
-  }
+  lck.wait(Smoker::cv, [&](){ return (items[prev] > 0 && items[next] > 0) || Smoker::closed; });
+
+  if(items[prev] <= 0 || items[next] <= 0)
+    return false;
+
+  wait_times.record(std::chrono::steady_clock::now() - start);
 
   // critical section
   get_items(items);
@@ -104,7 +130,24 @@ void Smoker::can_smoke(std::map<Item, int> &items){
 
   // unlock
   Smoker::cv.notify_all();
+  lck.unlock();
   wait();
+  return true;
+}
+
+// close the table, smokers return from can_smoke once nothing is left for them
+void Smoker::close(){
+  std::lock_guard<std::mutex> lck(Smoker::mtx);
+
+  Smoker::closed = true;
+  Smoker::cv.notify_all();
+}
+
+// not safe while smokers are waiting
+void Smoker::open(){
+  std::lock_guard<std::mutex> lck(Smoker::mtx);
+
+  Smoker::closed = false;
 }
 
 // critical section
@@ -123,7 +166,8 @@ void Smoker::get_items(std::map<Item, int> &items){
 void Smoker::smoke(){
   state = Smoker_state::Smoking;
 
-  std::cout << id << ": " << "Smoking... " << num_smokes + 1 << "\n";
+  if(options.verbose)
+    log_event(": Smoking... ", id, num_smokes + 1);
   for(std::map<Item, int>::iterator mi=inventory.begin();
                  mi!=inventory.end();
                  ++mi){
@@ -136,21 +180,25 @@ void Smoker::smoke(){
   state = Smoker_state::Waiting;
 }
 
-// wait after smoking
+// smoke for the work time, then wait for the think time
 void Smoker::wait(){
-  std::this_thread::sleep_for(std::chrono::seconds(1));
+  pause_for(options.work);
+  pause_for(options.think);
 }
 
 class Merchant {
   public:
     // constructor
-    Merchant();
+    Merchant(RunConfig = RunConfig());
 
     // main loop
     void can_produce(std::map<Item, int>&);
 
   private:
     Merchant_state state;
+    RunConfig options;
+    std::mt19937 rng;
+    static ContentionSite site;
 
     // critical section, adding items to shared pool
     void produce_items(std::map<Item, int>&);
@@ -159,30 +207,32 @@ class Merchant {
     void wait();
 };
 
+ContentionSite Merchant::site("smoker table (merchant)");
+
 // constructor
-Merchant::Merchant() : state(Merchant_state::Waiting) {}
+Merchant::Merchant(RunConfig options) : state(Merchant_state::Waiting), options(options), rng(options.seed) {}
 
 // main loop, contains critical section
 void Merchant::can_produce(std::map<Item, int> &items){
-  std::unique_lock<std::mutex> lck(Smoker::mtx);
+  ContendedLock lck(Smoker::mtx, Merchant::site);
 
   // wait for items to be depleted, using the Smoker class locking mechanisms
-  while(items[Item::Paper] > 0 || items[Item::Tobacco] > 0 || items[Item::Lighter] > 0){
-    Smoker::cv.wait(lck);
-  }
+  lck.wait(Smoker::cv, [&](){ return items[Item::Paper] <= 0 && items[Item::Tobacco] <= 0 && items[Item::Lighter] <= 0; });
 
   // critical section
   produce_items(items);
 
   Smoker::cv.notify_all();
+  lck.unlock();
   wait();
 }
 
 // critical section
 void Merchant::produce_items(std::map<Item, int> &items){
-  int r = random() % 3;
+  int r = rng() % 3;
 
-  std::cout << "Producing ... " << r << "\n";
+  if(options.verbose)
+    log_event("Producing ... ", -1, r);
   state = Merchant_state::Producing;
 
   // corresponds to id
@@ -204,7 +254,7 @@ void Merchant::produce_items(std::map<Item, int> &items){
 
 // wait after producing items
 void Merchant::wait(){
-  std::this_thread::sleep_for(std::chrono::seconds(1));
+  pause_for(options.think);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,235 @@
+// smoker_atomic.h
+// author:  Joseph Perry
+// desc:    This file defines a lock-free inventory table for the smoker problem.
+//          The item counts are packed into one atomic word so a smoker claims
+//          both missing items with a single compare-and-swap. Threads only
+//          sleep (std::atomic::wait, a futex on Linux) when nothing is
+//          available after a short spin. Requires C++20.
+
+#ifndef SMOKER_ATOMIC_H
+#define SMOKER_ATOMIC_H
+
+#include "smoker.h"
+#include <atomic>
+#include <cstdint>
+
+// Shared table, 8 bits of count per item and a closed flag in one word
+class AtomicTable {
+  public:
+    static const int ITEMS = 3;
+
+    // constructor
+    AtomicTable();
+
+    // take one of each of items a and b in a single step, false if either is missing
+    bool try_claim(int, int);
+
+    // claim items a and b for smoker id, sleeping if they are not there;
+    // false once the table is closed and the items never arrived
+    bool claim(int, int, int);
+
+    // place one of each of items a and b and wake the smoker that needs them
+    void publish(int, int);
+
+    // block until every item has been taken
+    void wait_empty();
+
+    // no more items will be produced, wakes every waiting smoker
+    void close();
+
+  private:
+    static const uint32_t CLOSED = 1u << 31;
+    static const uint32_t COUNTS = 0x00ffffff;
+    static const int SPINS = 128;
+
+    std::atomic<uint32_t> word;
+    std::atomic<uint32_t> wakeups[ITEMS];       // bumped to wake smoker i
+    std::atomic<uint32_t> taken;                // bumped to wake the merchant
+
+    static uint32_t inline one(int item){ return 1u << (8 * item); }
+    static uint32_t inline count(uint32_t w, int item){ return (w >> (8 * item)) & 0xff; }
+};
+
+// constructor
+AtomicTable::AtomicTable() : word(0), taken(0) {
+  for(int i = 0; i < ITEMS; ++i)
+    wakeups[i].store(0);
+}
+
+bool AtomicTable::try_claim(int a, int b){
+  uint32_t w = word.load(std::memory_order_acquire);
+
+  while(count(w, a) > 0 && count(w, b) > 0){
+    if(word.compare_exchange_weak(w, w - one(a) - one(b), std::memory_order_acq_rel, std::memory_order_acquire)){
+      // the merchant only cares once the table is empty
+      if(((w - one(a) - one(b)) & COUNTS) == 0){
+        taken.fetch_add(1, std::memory_order_release);
+        taken.notify_one();
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool AtomicTable::claim(int a, int b, int id){
+  uint32_t seen;
+
+  while(true){
+    // read the wakeup counter first so a publish after the failed claim is never missed
+    seen = wakeups[id].load(std::memory_order_acquire);
+
+    for(int i = 0; i < SPINS; ++i){
+      if(try_claim(a, b))
+        return true;
+      if(word.load(std::memory_order_relaxed) & CLOSED)
+        return try_claim(a, b);
+    }
+
+    wakeups[id].wait(seen, std::memory_order_acquire);
+  }
+}
+
+void AtomicTable::publish(int a, int b){
+  int id = ITEMS - a - b;       // the remaining item identifies the smoker
+
+  word.fetch_add(one(a) + one(b), std::memory_order_release);
+  wakeups[id].fetch_add(1, std::memory_order_release);
+  wakeups[id].notify_one();
+}
+
+void AtomicTable::wait_empty(){
+  uint32_t seen;
+
+  while(true){
+    seen = taken.load(std::memory_order_acquire);
+
+    for(int i = 0; i < SPINS; ++i)
+      if((word.load(std::memory_order_acquire) & COUNTS) == 0)
+        return;
+
+    taken.wait(seen, std::memory_order_acquire);
+  }
+}
+
+void AtomicTable::close(){
+  word.fetch_or(CLOSED, std::memory_order_release);
+
+  for(int i = 0; i < ITEMS; ++i){
+    wakeups[i].fetch_add(1, std::memory_order_release);
+    wakeups[i].notify_all();
+  }
+}
+
+class AtomicSmoker {
+  public:
+    // constructor function
+    AtomicSmoker(Item, RunConfig = RunConfig());
+
+    // main loop, returns false once the table is closed and empty
+    bool can_smoke(AtomicTable&);
+
+    // getter for the number of times this smoker has smoked
+    int inline smokes(){ return num_smokes; }
+
+    // getter for the time spent waiting for items on each round
+    const LatencyHistogram& waits(){ return wait_times; }
+
+  private:
+    Smoker_state state;
+    RunConfig options;
+    LatencyHistogram wait_times;
+    int num_smokes;
+    int id, prev, next;
+
+    // consume items
+    void smoke();
+
+    // wait for sometime after smoking
+    void wait();
+};
+
+// constructor, the smoker holds item and needs the other two
+AtomicSmoker::AtomicSmoker(Item item, RunConfig options) : state(Smoker_state::Waiting), options(options) {
+  id = static_cast<int>(item);
+  next = (id + 1) % AtomicTable::ITEMS;
+  prev = (id + 2) % AtomicTable::ITEMS;
+  num_smokes = 0;
+}
+
+// main loop, no mutex is taken anywhere
+bool AtomicSmoker::can_smoke(AtomicTable &table){
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  if(!table.claim(prev, next, id))
+    return false;
+
+  wait_times.record(std::chrono::steady_clock::now() - start);
+
+  smoke();
+  wait();
+  return true;
+}
+
+// consume items
+void AtomicSmoker::smoke(){
+  state = Smoker_state::Smoking;
+
+  if(options.verbose)
+    log_event(": Smoking... ", id, num_smokes + 1);
+
+  num_smokes++;
+  state = Smoker_state::Waiting;
+}
+
+// smoke for the work time, then wait for the think time
+void AtomicSmoker::wait(){
+  pause_for(options.work);
+  pause_for(options.think);
+}
+
+class AtomicMerchant {
+  public:
+    // constructor
+    AtomicMerchant(RunConfig = RunConfig());
+
+    // main loop
+    void can_produce(AtomicTable&);
+
+  private:
+    Merchant_state state;
+    RunConfig options;
+    std::mt19937 rng;
+
+    // wait after producing items
+    void wait();
+};
+
+// constructor
+AtomicMerchant::AtomicMerchant(RunConfig options) : state(Merchant_state::Waiting), options(options), rng(options.seed) {}
+
+// main loop, waits for the table to empty then publishes two items
+void AtomicMerchant::can_produce(AtomicTable &table){
+  int r;
+
+  table.wait_empty();
+
+  // r corresponds to the id of the smoker being served
+  state = Merchant_state::Producing;
+  r = rng() % AtomicTable::ITEMS;
+  table.publish((r + 1) % AtomicTable::ITEMS, (r + 2) % AtomicTable::ITEMS);
+  state = Merchant_state::Waiting;
+
+  if(options.verbose)
+    log_event("Producing ... ", -1, r);
+
+  wait();
+}
+
+// wait after producing items
+void AtomicMerchant::wait(){
+  pause_for(options.think);
+}
+
+#endif
@@ -0,0 +1,206 @@
+// smoker_bench.cpp
+// author:  Joseph Perry
+// desc:    Measures merchant -> smoker handoffs per second for the broadcast
+//          design in smoker.h, the per-smoker signalling design in
+//          smoker_signal.h, the lock-free table in smoker_atomic.h, the tasks
+//          in smoker_tasks.h and the coroutines in smoker_coro.h, with the
+//          sleep_for delays and printing disabled. Also measures raw
+//          claims/sec on the lock-free table. Requires C++20.
+//
+//          usage: ./smoker_bench [rounds]
+
+#include "smoker.h"
+#include "smoker_signal.h"
+#include "smoker_atomic.h"
+#include "smoker_tasks.h"
+#include "smoker_coro.h"
+#include <sstream>
+#include <vector>
+#include <memory>
+
+// one handoff is the merchant placing two items and a smoker taking them
+void report(const char *name, int rounds, std::chrono::steady_clock::duration elapsed, std::vector<int> smokes){
+  double seconds = std::chrono::duration<double>(elapsed).count();
+
+  std::cout << name << ": " << rounds << " handoffs in " << seconds << " s, "
+            << rounds / seconds << " handoffs/sec, smokes";
+  for(int s : smokes)
+    std::cout << " " << s;
+  std::cout << "\n";
+}
+
+// shared mutex and condition variable, every state change wakes everyone
+void bench_broadcast(int rounds, RunConfig options){
+  std::map<Item, int> items = { { Item::Paper, 0 },
+                                { Item::Tobacco, 0 },
+                                { Item::Lighter, 0 } };
+  Smoker paper(Item::Paper, items, options);
+  Smoker tobacco(Item::Tobacco, items, options);
+  Smoker lighter(Item::Lighter, items, options);
+  Merchant merchant(options);
+  Smoker::open();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  std::thread paper_thread([&paper, &items](){ while(paper.can_smoke(items)); });
+  std::thread tobacco_thread([&tobacco, &items](){ while(tobacco.can_smoke(items)); });
+  std::thread lighter_thread([&lighter, &items](){ while(lighter.can_smoke(items)); });
+
+  for(int i = 0; i < rounds; ++i)
+    merchant.can_produce(items);
+  Smoker::close();
+
+  paper_thread.join();
+  tobacco_thread.join();
+  lighter_thread.join();
+
+  report("broadcast", rounds, std::chrono::steady_clock::now() - start,
+         { paper.smokes(), tobacco.smokes(), lighter.smokes() });
+}
+
+// per-smoker condition variables, the merchant wakes only the smoker it served
+void bench_signal(int rounds, RunConfig options){
+  SignalTable table;
+  SignalSmoker paper(Item::Paper, options);
+  SignalSmoker tobacco(Item::Tobacco, options);
+  SignalSmoker lighter(Item::Lighter, options);
+  SignalMerchant merchant(options);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  std::thread paper_thread([&paper, &table](){ while(paper.can_smoke(table)); });
+  std::thread tobacco_thread([&tobacco, &table](){ while(tobacco.can_smoke(table)); });
+  std::thread lighter_thread([&lighter, &table](){ while(lighter.can_smoke(table)); });
+
+  for(int i = 0; i < rounds; ++i)
+    merchant.can_produce(table);
+  table.close();
+
+  paper_thread.join();
+  tobacco_thread.join();
+  lighter_thread.join();
+
+  report("signal", rounds, std::chrono::steady_clock::now() - start,
+         { paper.smokes(), tobacco.smokes(), lighter.smokes() });
+}
+
+// lock-free table, smokers claim both items with one compare-and-swap
+void bench_atomic(int rounds, RunConfig options){
+  AtomicTable table;
+  AtomicSmoker paper(Item::Paper, options);
+  AtomicSmoker tobacco(Item::Tobacco, options);
+  AtomicSmoker lighter(Item::Lighter, options);
+  AtomicMerchant merchant(options);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  std::thread paper_thread([&paper, &table](){ while(paper.can_smoke(table)); });
+  std::thread tobacco_thread([&tobacco, &table](){ while(tobacco.can_smoke(table)); });
+  std::thread lighter_thread([&lighter, &table](){ while(lighter.can_smoke(table)); });
+
+  for(int i = 0; i < rounds; ++i)
+    merchant.can_produce(table);
+  table.close();
+
+  paper_thread.join();
+  tobacco_thread.join();
+  lighter_thread.join();
+
+  report("atomic", rounds, std::chrono::steady_clock::now() - start,
+         { paper.smokes(), tobacco.smokes(), lighter.smokes() });
+}
+
+// raw table throughput, every thread publishes a pair and claims it back
+void bench_atomic_claims(int rounds){
+  AtomicTable table;
+  std::vector<std::thread> threads;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double seconds;
+
+  for(int id = 0; id < AtomicTable::ITEMS; ++id)
+    threads.push_back(std::thread([&table, id, rounds](){
+      int a = (id + 1) % AtomicTable::ITEMS;
+      int b = (id + 2) % AtomicTable::ITEMS;
+
+      for(int i = 0; i < rounds; ++i){
+        table.publish(a, b);
+        while(!table.try_claim(a, b));
+      }
+    }));
+  for(auto &t : threads)
+    t.join();
+
+  seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "atomic claims: " << AtomicTable::ITEMS * rounds << " claims in " << seconds << " s, "
+            << AtomicTable::ITEMS * rounds / seconds << " claims/sec\n";
+}
+
+// smokers and merchant as tasks on a work-stealing pool, per_item smokers hold each item
+void bench_tasks(int rounds, RunConfig options, int per_item){
+  WorkStealingPool pool;
+  TaskTable table;
+  std::vector<std::unique_ptr<SmokerTask>> smokers;
+  std::vector<int> smokes(TaskTable::ITEMS, 0);
+  MerchantTask merchant(table, rounds, options);
+  std::ostringstream name;
+
+  for(int i = 0; i < per_item; ++i)
+    for(Item item : { Item::Paper, Item::Tobacco, Item::Lighter })
+      smokers.emplace_back(new SmokerTask(item, table, options));
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(auto &s : smokers)
+    pool.spawn(s.get());
+  pool.spawn(&merchant);
+  pool.wait();
+
+  for(size_t i = 0; i < smokers.size(); ++i)
+    smokes[i % TaskTable::ITEMS] += smokers[i]->smokes();
+
+  name << "tasks x" << smokers.size();
+  report(name.str().c_str(), rounds, std::chrono::steady_clock::now() - start, smokes);
+  pool.print_stats(std::cout);
+}
+
+// smokers and merchant as coroutines on one thread
+void bench_coro(int rounds, RunConfig options){
+  EventLoop loop;
+  CoroTable table;
+  CoroSmoker paper(Item::Paper, options);
+  CoroSmoker tobacco(Item::Tobacco, options);
+  CoroSmoker lighter(Item::Lighter, options);
+  CoroMerchant merchant(options);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  loop.spawn(paper.smoke(loop, table));
+  loop.spawn(tobacco.smoke(loop, table));
+  loop.spawn(lighter.smoke(loop, table));
+  loop.spawn(merchant.produce(loop, table, rounds));
+  loop.run();
+
+  report("coroutines", rounds, std::chrono::steady_clock::now() - start,
+         { paper.smokes(), tobacco.smokes(), lighter.smokes() });
+}
+
+int main(int argc, char *argv[]){
+  int rounds = 100000;
+  RunConfig options;
+
+  if(argc > 1){
+    std::istringstream ss(argv[1]);
+    if(!(ss >> rounds)){
+      std::cerr << "Invalid rounds : " << argv[1] << "\n";
+      return 1;
+    }
+  }
+
+  options.think = std::chrono::nanoseconds(0);
+  options.verbose = false;
+
+  bench_broadcast(rounds, options);
+  bench_signal(rounds, options);
+  bench_atomic(rounds, options);
+  bench_tasks(rounds, options, 1);
+  bench_tasks(rounds, options, 10000);
+  bench_coro(rounds, options);
+  bench_atomic_claims(rounds * 10);
+
+  return 0;
+}
@@ -0,0 +1,144 @@
+// smoker_coro.h
+// author:  Joseph Perry
+// desc:    This file defines smokers and a merchant that are C++20 coroutines
+//          on an EventLoop (see concurrency/coroutine.h). Waiting for items,
+//          for an empty table and the think and work pauses are co_awaits,
+//          so no thread ever blocks. Requires C++20.
+
+#ifndef SMOKER_CORO_H
+#define SMOKER_CORO_H
+
+#include "smoker.h"
+#include "../concurrency/coroutine.h"
+
+// Shared table, one wait list per item a smoker holds plus one for the merchant
+class CoroTable {
+  public:
+    static const int ITEMS = 3;
+
+    // constructor
+    CoroTable();
+
+    // no more items will be produced, wakes every waiting smoker
+    void close();
+
+    // getter for the wait latency of every smoker
+    const LatencyHistogram& waits(){ return wait_times; }
+
+  private:
+    int items[ITEMS];
+    WaitList smokers[ITEMS];
+    WaitList merchant;
+    bool closed;
+    LatencyHistogram wait_times;
+
+    friend class CoroSmoker;
+    friend class CoroMerchant;
+};
+
+// constructor
+CoroTable::CoroTable() : closed(false) {
+  for(int i = 0; i < ITEMS; ++i)
+    items[i] = 0;
+}
+
+void CoroTable::close(){
+  closed = true;
+  for(int i = 0; i < ITEMS; ++i)
+    smokers[i].wake_all();
+  merchant.wake_all();
+}
+
+class CoroSmoker {
+  public:
+    // constructor, the smoker holds item and needs the other two
+    CoroSmoker(Item, RunConfig = RunConfig());
+
+    // the smoker's whole life, ends once the table is closed and empty
+    CoroAgent smoke(EventLoop&, CoroTable&);
+
+    // getter for the number of times this smoker has smoked
+    int inline smokes(){ return num_smokes; }
+
+  private:
+    RunConfig options;
+    int num_smokes;
+    int id, prev, next;
+};
+
+// constructor
+CoroSmoker::CoroSmoker(Item item, RunConfig options) : options(options), num_smokes(0) {
+  id = static_cast<int>(item);
+  next = (id + 1) % CoroTable::ITEMS;
+  prev = (id + 2) % CoroTable::ITEMS;
+}
+
+CoroAgent CoroSmoker::smoke(EventLoop &loop, CoroTable &table){
+  while(true){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // wait for items
+    while((table.items[prev] <= 0 || table.items[next] <= 0) && !table.closed)
+      co_await table.smokers[id].wait();
+
+    if(table.items[prev] <= 0 || table.items[next] <= 0)
+      co_return;
+
+    table.wait_times.record(std::chrono::steady_clock::now() - start);
+
+    --table.items[prev];
+    --table.items[next];
+    table.merchant.wake_one();
+
+    if(options.verbose)
+      log_event(": Smoking... ", id, num_smokes + 1);
+    num_smokes++;
+
+    // smoke for the work time, then wait for the think time
+    co_await loop.sleep_for(options.work);
+    co_await loop.sleep_for(options.think);
+  }
+}
+
+class CoroMerchant {
+  public:
+    // constructor
+    CoroMerchant(RunConfig = RunConfig());
+
+    // the merchant's whole life, closes the table after rounds handoffs, 0 is unbounded
+    CoroAgent produce(EventLoop&, CoroTable&, long);
+
+  private:
+    RunConfig options;
+    std::mt19937 rng;
+};
+
+// constructor
+CoroMerchant::CoroMerchant(RunConfig options) : options(options), rng(options.seed) {}
+
+// r corresponds to the id of the smoker being served
+CoroAgent CoroMerchant::produce(EventLoop &loop, CoroTable &table, long rounds){
+  for(long round = 0; (rounds == 0 || round < rounds) && !table.closed; ++round){
+    int r;
+
+    // wait for items to be depleted
+    while((table.items[0] > 0 || table.items[1] > 0 || table.items[2] > 0) && !table.closed)
+      co_await table.merchant.wait();
+    if(table.closed)
+      break;
+
+    r = rng() % CoroTable::ITEMS;
+    ++table.items[(r + 1) % CoroTable::ITEMS];
+    ++table.items[(r + 2) % CoroTable::ITEMS];
+    table.smokers[r].wake_one();
+
+    if(options.verbose)
+      log_event("Producing ... ", -1, r);
+
+    co_await loop.sleep_for(options.think);
+  }
+
+  table.close();
+}
+
+#endif
@@ -0,0 +1,182 @@
+// smoker_signal.h
+// author:  Joseph Perry
+// desc:    This file defines a variant of the Smoker and Merchant classes in which
+//          the merchant signals only the smoker whose items it placed, and
+//          waits on its own signal, instead of broadcasting on one shared
+//          condition variable.
+
+#ifndef SMOKER_SIGNAL_H
+#define SMOKER_SIGNAL_H
+
+#include "smoker.h"
+
+const int NUM_ITEMS = 3;
+
+// Shared table, one condition variable per smoker plus one for the merchant
+class SignalTable {
+  public:
+    // constructor
+    SignalTable();
+
+    // no more items will be produced, wakes every waiting smoker
+    void close();
+
+  private:
+    std::mutex mtx;
+    std::condition_variable smoker_cv[NUM_ITEMS];
+    std::condition_variable merchant_cv;
+    int items[NUM_ITEMS];
+    bool closed;
+
+    friend class SignalSmoker;
+    friend class SignalMerchant;
+};
+
+// constructor
+SignalTable::SignalTable() : closed(false) {
+  for(int i = 0; i < NUM_ITEMS; ++i)
+    items[i] = 0;
+}
+
+// close the table, smokers return from can_smoke once nothing is left for them
+void SignalTable::close(){
+  std::lock_guard<std::mutex> lck(mtx);
+
+  closed = true;
+  for(int i = 0; i < NUM_ITEMS; ++i)
+    smoker_cv[i].notify_one();
+}
+
+class SignalSmoker {
+  public:
+    // constructor function
+    SignalSmoker(Item, RunConfig = RunConfig());
+
+    // main loop, returns false once the table is closed and empty
+    bool can_smoke(SignalTable&);
+
+    // getter for the number of times this smoker has smoked
+    int inline smokes(){ return num_smokes; }
+
+    // getter for the time spent waiting for items on each round
+    const LatencyHistogram& waits(){ return wait_times; }
+
+  private:
+    Smoker_state state;
+    RunConfig options;
+    LatencyHistogram wait_times;
+    int num_smokes;
+    int id, prev, next;
+
+    // consume items
+    void smoke();
+
+    // wait for sometime after smoking
+    void wait();
+};
+
+// constructor, the smoker holds item and needs the other two
+SignalSmoker::SignalSmoker(Item item, RunConfig options) : state(Smoker_state::Waiting), options(options) {
+  id = static_cast<int>(item);
+  next = (id + 1) % NUM_ITEMS;
+  prev = (id + 2) % NUM_ITEMS;
+  num_smokes = 0;
+}
+
+// concurrent main loop, only this smoker's condition variable is waited on
+bool SignalSmoker::can_smoke(SignalTable &table){
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lck(table.mtx);
+
+  // wait for items
+  while((table.items[prev] <= 0 || table.items[next] <= 0) && !table.closed){
+    table.smoker_cv[id].wait(lck);
+  }
+
+  if(table.items[prev] <= 0 || table.items[next] <= 0)
+    return false;
+
+  wait_times.record(std::chrono::steady_clock::now() - start);
+
+  // critical section
+  --table.items[prev];
+  --table.items[next];
+  lck.unlock();
+
+  // table is empty again, only the merchant needs to know
+  table.merchant_cv.notify_one();
+
+  smoke();
+  wait();
+  return true;
+}
+
+// consume items
+void SignalSmoker::smoke(){
+  state = Smoker_state::Smoking;
+
+  if(options.verbose)
+    log_event(": Smoking... ", id, num_smokes + 1);
+
+  num_smokes++;
+  state = Smoker_state::Waiting;
+}
+
+// smoke for the work time, then wait for the think time
+void SignalSmoker::wait(){
+  pause_for(options.work);
+  pause_for(options.think);
+}
+
+class SignalMerchant {
+  public:
+    // constructor
+    SignalMerchant(RunConfig = RunConfig());
+
+    // main loop
+    void can_produce(SignalTable&);
+
+  private:
+    Merchant_state state;
+    RunConfig options;
+    std::mt19937 rng;
+
+    // wait after producing items
+    void wait();
+};
+
+// constructor
+SignalMerchant::SignalMerchant(RunConfig options) : state(Merchant_state::Waiting), options(options), rng(options.seed) {}
+
+// main loop, waits on the merchant's own condition variable and wakes one smoker
+void SignalMerchant::can_produce(SignalTable &table){
+  std::unique_lock<std::mutex> lck(table.mtx);
+  int r;
+
+  // wait for items to be depleted
+  while(table.items[0] > 0 || table.items[1] > 0 || table.items[2] > 0){
+    table.merchant_cv.wait(lck);
+  }
+
+  // critical section, r corresponds to the id of the smoker being served
+  state = Merchant_state::Producing;
+  r = rng() % NUM_ITEMS;
+  ++table.items[(r + 1) % NUM_ITEMS];
+  ++table.items[(r + 2) % NUM_ITEMS];
+  state = Merchant_state::Waiting;
+  lck.unlock();
+
+  table.smoker_cv[r].notify_one();
+
+  if(options.verbose)
+    log_event("Producing ... ", -1, r);
+
+  wait();
+}
+
+// wait after producing items
+void SignalMerchant::wait(){
+  pause_for(options.think);
+}
+
+#endif
@@ -0,0 +1,216 @@
+// smoker_tasks.h
+// author:  Joseph Perry
+// desc:    This file defines smokers and a merchant that run as tasks on a
+//          WorkStealingPool (see concurrency/work_stealing.h) rather than on a
+//          thread each. A smoker whose items are missing parks on the table
+//          and is resumed by the merchant when they are placed; the merchant
+//          parks until the table is empty. Any number of smokers may hold the
+//          same item, the merchant resumes the one waiting longest.
+//
+//          Think and work times are not simulated, a task must never sleep on
+//          its worker.
+
+#ifndef SMOKER_TASKS_H
+#define SMOKER_TASKS_H
+
+#include "smoker.h"
+#include "../concurrency/work_stealing.h"
+#include <deque>
+
+// Shared table, one list of parked smokers per item they hold
+class TaskTable {
+  public:
+    static const int ITEMS = 3;
+
+    // constructor
+    TaskTable();
+
+    // no more items will be produced, parked tasks are resumed to leave
+    void close(WorkStealingPool&);
+
+  private:
+    std::mutex mtx;
+    int items[ITEMS];
+    std::deque<Task*> smokers[ITEMS];
+    Task *merchant;                             // parked merchant, if any
+    bool closed;
+
+    friend class SmokerTask;
+    friend class MerchantTask;
+};
+
+// constructor
+TaskTable::TaskTable() : merchant(nullptr), closed(false) {
+  for(int i = 0; i < ITEMS; ++i)
+    items[i] = 0;
+}
+
+void TaskTable::close(WorkStealingPool &pool){
+  std::deque<Task*> parked;
+
+  {
+    std::lock_guard<std::mutex> lck(mtx);
+
+    closed = true;
+    for(int i = 0; i < ITEMS; ++i){
+      parked.insert(parked.end(), smokers[i].begin(), smokers[i].end());
+      smokers[i].clear();
+    }
+    if(merchant != nullptr)
+      parked.push_back(merchant);
+    merchant = nullptr;
+  }
+
+  for(Task *t : parked)
+    pool.resume(t);
+}
+
+class SmokerTask : public Task {
+  public:
+    // constructor, the smoker holds item and needs the other two
+    SmokerTask(Item, TaskTable&, RunConfig = RunConfig());
+
+    // one smoke per step, parks while the items are missing
+    Task_state run(WorkStealingPool&);
+
+    // getter for the number of times this smoker has smoked
+    int inline smokes(){ return num_smokes; }
+
+    // getter for the time spent waiting for items on each round
+    const LatencyHistogram& waits(){ return wait_times; }
+
+  private:
+    Smoker_state state;
+    TaskTable &table;
+    RunConfig options;
+    LatencyHistogram wait_times;
+    std::chrono::steady_clock::time_point start;
+    bool waiting;                               // start holds when this round began
+    int num_smokes;
+    int id, prev, next;
+
+    // consume items
+    void smoke();
+};
+
+// constructor
+SmokerTask::SmokerTask(Item item, TaskTable &table, RunConfig options)
+  : state(Smoker_state::Waiting), table(table), options(options), waiting(false) {
+  id = static_cast<int>(item);
+  next = (id + 1) % TaskTable::ITEMS;
+  prev = (id + 2) % TaskTable::ITEMS;
+  num_smokes = 0;
+}
+
+Task_state SmokerTask::run(WorkStealingPool &pool){
+  Task *merchant = nullptr;
+
+  if(!waiting){
+    waiting = true;
+    start = std::chrono::steady_clock::now();
+  }
+
+  {
+    std::lock_guard<std::mutex> lck(table.mtx);
+
+    if(table.items[prev] <= 0 || table.items[next] <= 0){
+      if(table.closed)
+        return Task_state::Done;
+      table.smokers[id].push_back(this);
+      return Task_state::Parked;
+    }
+
+    --table.items[prev];
+    --table.items[next];
+
+    // the table is empty again, the merchant can produce
+    std::swap(merchant, table.merchant);
+  }
+
+  if(merchant != nullptr)
+    pool.resume(merchant);
+
+  wait_times.record(std::chrono::steady_clock::now() - start);
+  waiting = false;
+  smoke();
+  return Task_state::Yield;
+}
+
+// consume items
+void SmokerTask::smoke(){
+  state = Smoker_state::Smoking;
+
+  if(options.verbose)
+    log_event(": Smoking... ", id, num_smokes + 1);
+
+  num_smokes++;
+  state = Smoker_state::Waiting;
+}
+
+class MerchantTask : public Task {
+  public:
+    // constructor, stops and closes the table after rounds handoffs, 0 is unbounded
+    MerchantTask(TaskTable&, long, RunConfig = RunConfig());
+
+    // one handoff per step, parks while the table is not empty
+    Task_state run(WorkStealingPool&);
+
+    // getter for the number of handoffs so far
+    long inline handoffs(){ return num_rounds; }
+
+  private:
+    Merchant_state state;
+    TaskTable &table;
+    RunConfig options;
+    std::mt19937 rng;
+    long rounds, num_rounds;
+};
+
+// constructor
+MerchantTask::MerchantTask(TaskTable &table, long rounds, RunConfig options)
+  : state(Merchant_state::Waiting), table(table), options(options), rng(options.seed), rounds(rounds), num_rounds(0) {}
+
+// r corresponds to the id of the smoker being served
+Task_state MerchantTask::run(WorkStealingPool &pool){
+  Task *smoker = nullptr;
+  int r;
+
+  if(rounds > 0 && num_rounds >= rounds){
+    table.close(pool);
+    return Task_state::Done;
+  }
+
+  {
+    std::lock_guard<std::mutex> lck(table.mtx);
+
+    if(table.closed)
+      return Task_state::Done;
+
+    if(table.items[0] > 0 || table.items[1] > 0 || table.items[2] > 0){
+      table.merchant = this;
+      return Task_state::Parked;
+    }
+
+    state = Merchant_state::Producing;
+    r = rng() % TaskTable::ITEMS;
+    ++table.items[(r + 1) % TaskTable::ITEMS];
+    ++table.items[(r + 2) % TaskTable::ITEMS];
+    state = Merchant_state::Waiting;
+
+    if(!table.smokers[r].empty()){
+      smoker = table.smokers[r].front();
+      table.smokers[r].pop_front();
+    }
+  }
+
+  if(smoker != nullptr)
+    pool.resume(smoker);
+
+  if(options.verbose)
+    log_event("Producing ... ", -1, r);
+
+  ++num_rounds;
+  return Task_state::Yield;
+}
+
+#endif
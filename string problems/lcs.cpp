@@ -1,71 +1,79 @@
 // lcs.cpp
 // author:  Joseph Perry
-// desc:    This file computes the least common subsequence between two strings.
-
-#include <iostream>
-#include <string>
-#include <tuple>
-#include <vector>
-
-using namespace std;
-
-// builds a MxN table of 2-tuples to compute the least common subsequence
-vector<vector<tuple<int, char>>> lcs_length(string x, string y){
-  int m = x.size();
-  int n = y.size();
-  int i, j;
-
-  vector<vector<tuple<int, char>>> table(m+1, vector<tuple<int, char>>(n+1, make_tuple(0, ' ')));
-
-  for(i = 1; i <= m; ++i){
-    for(j = 1; j <= n; ++j){
-      if(x[i-1] == y[j-1]){
-        table[i][j] = make_tuple(get<0>(table[i-1][j-1])+1, 'Q'); // Left diagonal
-
-      } else if(get<0>(table[i-1][j]) >= get<0>(table[i][j-1])){
-        table[i][j] = make_tuple(get<0>(table[i-1][j]), 'W');     // Up
-
-      } else {
-        table[i][j] = make_tuple(get<0>(table[i][j-1]), 'A');     // Left
-      }
-    }
-  }
-
-  return table;
-}
-
-// walks the table previously built and prints out the least common subsequence
-void print_lcs(vector<vector<tuple<int, char>>> &table, string x, int i, int j){
-  if(i == 0 || j == 0)
-    return;
-
-  if(get<1>(table[i][j]) == 'Q'){          // Left diagonal
-    print_lcs(table, x, i-1, j-1);
-    cout << x[i-1];
-
-  } else if(get<1>(table[i][j]) == 'W'){   // Up
-    print_lcs(table, x, i-1, j);
-
-  } else {                                // Left
-    print_lcs(table, x, i, j-1);
-  }
+// desc:    This file computes the least common subsequence between two strings,
+//          or the edits between them, with the full table or in linear
+//          space (see lcs.h).
+
+#include "lcs.h"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+// reads a whole file into s, false if it cannot be opened
+bool read_file(const char *path, string &s){
+  ifstream in(path, ios::binary);
+  stringstream ss;
+
+  if(!in)
+    return false;
+
+  ss << in.rdbuf();
+  s = ss.str();
+  return true;
 }
 
+// usage: lcs [--length | --linear | --diff] [--files] [x y]
+//   --length  only print the length, in two rolling rows
+//   --linear  Hirschberg's O(m+n) memory LCS instead of the full table
+//   --diff    print the edits turning x into y instead of the LCS
+//   --files   x and y are paths to files to compare
 int main(int argc, char *argv[]){
-  vector<vector<tuple<int, char>>> table;
   string x = "ABCBDAB";
   string y = "BDCABA";
+  bool length = false, linear = false, diff = false, files = false;
+  vector<char*> rest;
+
+  for(int i = 1; i < argc; ++i){
+    if(strcmp(argv[i], "--length") == 0)
+      length = true;
+    else if(strcmp(argv[i], "--linear") == 0)
+      linear = true;
+    else if(strcmp(argv[i], "--diff") == 0)
+      diff = true;
+    else if(strcmp(argv[i], "--files") == 0)
+      files = true;
+    else
+      rest.push_back(argv[i]);
+  }
 
-  if(argc >= 3){
-    x = argv[1];
-    y = argv[2];
+  if(rest.size() >= 2){
+    if(!files){
+      x = rest[0];
+      y = rest[1];
+    } else if(!read_file(rest[0], x) || !read_file(rest[1], y)){
+      cerr << "cannot read " << rest[0] << " or " << rest[1] << endl;
+      return 1;
+    }
   }
-  
-  table = lcs_length(x, y);
 
-  cout << x << endl;
-  cout << y << endl;
-  print_lcs(table, x, x.size(), y.size());
+  // large inputs are not echoed
+  if(!files){
+    cout << x << endl;
+    cout << y << endl;
+  }
+
+  if(length){
+    cout << lcs_size(x, y) << endl;
+  } else if(linear){
+    cout << hirschberg_lcs(x, y);
+  } else {
+    LcsTable table(x, y);
+
+    if(diff)
+      print_diff(cout, lcs_diff(table), x, y);
+    else
+      cout << lcs_string(table, x);
+  }
 
   return 0;
 }
\ No newline at end of file
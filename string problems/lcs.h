@@ -0,0 +1,322 @@
+// lcs.h
+// author:  Joseph Perry
+// desc:    Computes the longest common subsequence between two strings: with the
+//          full table, filled serially or in parallel tiles into one packed
+//          buffer and walked back into the subsequence or a diff script, with
+//          two rolling rows when only the length is needed, and with
+//          Hirschberg's divide and conquer, which recovers the subsequence in
+//          O(m+n) memory.
+
+#ifndef LCS_H
+#define LCS_H
+
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+using namespace std;
+
+// builds a MxN table of 2-tuples to compute the least common subsequence, the
+// reference LcsTable is measured against in lcs_bench.cpp
+vector<vector<tuple<int, char>>> lcs_length(string x, string y){
+  int m = x.size();
+  int n = y.size();
+  int i, j;
+
+  vector<vector<tuple<int, char>>> table(m+1, vector<tuple<int, char>>(n+1, make_tuple(0, ' ')));
+
+  for(i = 1; i <= m; ++i){
+    for(j = 1; j <= n; ++j){
+      if(x[i-1] == y[j-1]){
+        table[i][j] = make_tuple(get<0>(table[i-1][j-1])+1, 'Q'); // Left diagonal
+
+      } else if(get<0>(table[i-1][j]) >= get<0>(table[i][j-1])){
+        table[i][j] = make_tuple(get<0>(table[i-1][j]), 'W');     // Up
+
+      } else {
+        table[i][j] = make_tuple(get<0>(table[i][j-1]), 'A');     // Left
+      }
+    }
+  }
+
+  return table;
+}
+
+// The full table in one contiguous buffer, each cell a packed length and step.
+// The fill is cut into tiles; a tile needs only the tiles above and to its
+// left, so tiles on the same anti-diagonal are filled in parallel as soon as
+// their neighbours are done, and each tile's rows stay in cache while it runs.
+class LcsTable {
+  public:
+    enum Step : uint32_t { None = 0, Diagonal = 1, Up = 2, Left = 3 };
+
+    static const size_t TILE = 256;
+
+    // constructor, fills the table for x and y over threads (0 is one per core)
+    LcsTable(const string&, const string&, unsigned = 0);
+
+    // getters for the length and step of cell (i, j), 0 <= i <= m, 0 <= j <= n
+    int inline length(size_t i, size_t j) const { return static_cast<int>(cells[i*(n+1) + j] >> 2); }
+    Step inline step(size_t i, size_t j) const { return static_cast<Step>(cells[i*(n+1) + j] & 3); }
+
+    // getter for the length of the longest common subsequence
+    int inline length() const { return length(m, n); }
+
+    size_t inline rows() const { return m; }
+    size_t inline cols() const { return n; }
+
+  private:
+    size_t m, n;
+    vector<uint32_t> cells;                   // (m+1) x (n+1), row major, length << 2 | step
+
+    // fills the cells of tile (ti, tj)
+    void fill(const string&, const string&, size_t, size_t);
+};
+
+// tiles are handed out from a ready list once both of their predecessors are filled
+LcsTable::LcsTable(const string &x, const string &y, unsigned threads) : m(x.size()), n(y.size()), cells((m+1) * (n+1), 0) {
+  size_t tile_rows = (m + TILE - 1) / TILE;
+  size_t tile_cols = (n + TILE - 1) / TILE;
+  size_t total = tile_rows * tile_cols, done = 0;
+  vector<int> pending(total);
+  deque<size_t> ready;
+  mutex mtx;
+  condition_variable cv;
+  vector<thread> workers;
+
+  if(total == 0)
+    return;
+
+  for(size_t t = 0; t < total; ++t)
+    pending[t] = (t / tile_cols > 0) + (t % tile_cols > 0);
+  ready.push_back(0);
+
+  auto work = [&](){
+    unique_lock<mutex> lck(mtx);
+
+    while(true){
+      size_t t;
+
+      cv.wait(lck, [&](){ return !ready.empty() || done == total; });
+      if(ready.empty())
+        return;
+
+      t = ready.front();
+      ready.pop_front();
+
+      lck.unlock();
+      fill(x, y, t / tile_cols, t % tile_cols);
+      lck.lock();
+
+      // the tile below and the tile to the right
+      if(t / tile_cols + 1 < tile_rows && --pending[t + tile_cols] == 0){
+        ready.push_back(t + tile_cols);
+        cv.notify_one();
+      }
+      if(t % tile_cols + 1 < tile_cols && --pending[t + 1] == 0){
+        ready.push_back(t + 1);
+        cv.notify_one();
+      }
+      if(++done == total)
+        cv.notify_all();
+    }
+  };
+
+  if(threads == 0)
+    threads = max(1u, thread::hardware_concurrency());
+  threads = static_cast<unsigned>(min<size_t>(threads, min(tile_rows, tile_cols)));
+
+  for(unsigned i = 1; i < threads; ++i)
+    workers.emplace_back(work);
+  work();
+  for(thread &w : workers)
+    w.join();
+}
+
+// same recurrence and tie break as lcs_length
+void LcsTable::fill(const string &x, const string &y, size_t ti, size_t tj){
+  size_t ilo = 1 + ti*TILE, ihi = min(m + 1, ilo + TILE);
+  size_t jlo = 1 + tj*TILE, jhi = min(n + 1, jlo + TILE);
+
+  for(size_t i = ilo; i < ihi; ++i){
+    const uint32_t *prev = &cells[(i-1) * (n+1)];
+    uint32_t *row = &cells[i * (n+1)];
+    char a = x[i-1];
+
+    // selects rather than branches, matches are unpredictable
+    for(size_t j = jlo; j < jhi; ++j){
+      uint32_t diagonal = ((prev[j-1] >> 2) + 1) << 2 | Diagonal;
+      uint32_t up = (prev[j] >> 2) << 2 | Up;
+      uint32_t left = (row[j-1] >> 2) << 2 | Left;
+      uint32_t skip = up >> 2 >= left >> 2 ? up : left;
+
+      row[j] = a == y[j-1] ? diagonal : skip;
+    }
+  }
+}
+
+// walks the table back from (m, n) and returns the longest common subsequence
+string lcs_string(const LcsTable &table, const string &x){
+  size_t i = table.rows(), j = table.cols();
+  string out;
+
+  out.reserve(table.length());
+  while(i > 0 && j > 0){
+    switch(table.step(i, j)){
+      case LcsTable::Diagonal: out += x[--i]; --j; break;
+      case LcsTable::Up:       --i; break;
+      default:                 --j; break;
+    }
+  }
+
+  reverse(out.begin(), out.end());
+  return out;
+}
+
+enum class Edit_op : char { Keep = '=', Delete = '-', Insert = '+' };
+
+// a run of one operation, starting at x[x_pos] and y[y_pos]
+struct Edit {
+  Edit_op op;
+  size_t x_pos;
+  size_t y_pos;
+  size_t length;
+};
+
+// the edits turning x into y along the table's path, in order, with runs of
+// the same operation merged. Keep and Delete runs cover x, Keep and Insert y
+vector<Edit> lcs_diff(const LcsTable &table){
+  size_t i = table.rows(), j = table.cols();
+  vector<Edit> edits;
+
+  // walked backwards, so each run grows towards the start of the strings
+  while(i > 0 || j > 0){
+    Edit_op op;
+
+    if(i > 0 && j > 0 && table.step(i, j) == LcsTable::Diagonal)
+      op = Edit_op::Keep;
+    else if(i > 0 && (j == 0 || table.step(i, j) == LcsTable::Up))
+      op = Edit_op::Delete;
+    else
+      op = Edit_op::Insert;
+
+    if(op != Edit_op::Insert)
+      --i;
+    if(op != Edit_op::Delete)
+      --j;
+
+    if(!edits.empty() && edits.back().op == op){
+      edits.back().x_pos = i;
+      edits.back().y_pos = j;
+      ++edits.back().length;
+    } else {
+      edits.push_back(Edit{ op, i, j, 1 });
+    }
+  }
+
+  reverse(edits.begin(), edits.end());
+  return edits;
+}
+
+// one line per run: the operation, its length and the characters, from x for
+// Keep and Delete and from y for Insert
+void print_diff(ostream &out, const vector<Edit> &edits, const string &x, const string &y){
+  for(const Edit &e : edits){
+    out << static_cast<char>(e.op) << " " << e.length << " ";
+    if(e.op == Edit_op::Insert)
+      out.write(y.data() + e.y_pos, e.length);
+    else
+      out.write(x.data() + e.x_pos, e.length);
+    out << "\n";
+  }
+}
+
+// last row of the length table for x[xlo, xhi) against y[ylo, yhi), in two
+// rolling rows. With reverse set both ranges are read back to front, so
+// row[k] is the LCS length of the two suffixes where y's has k characters
+void lcs_row(const string &x, size_t xlo, size_t xhi, const string &y, size_t ylo, size_t yhi,
+             bool reverse, vector<int> &row){
+  size_t n = yhi - ylo;
+  vector<int> prev(n+1, 0);
+
+  row.assign(n+1, 0);
+  for(size_t i = 0; i < xhi - xlo; ++i){
+    char a = reverse ? x[xhi-1-i] : x[xlo+i];
+
+    swap(prev, row);
+    row[0] = 0;
+    for(size_t j = 1; j <= n; ++j){
+      char b = reverse ? y[yhi-j] : y[ylo+j-1];
+
+      if(a == b)
+        row[j] = prev[j-1] + 1;
+      else
+        row[j] = max(prev[j], row[j-1]);
+    }
+  }
+}
+
+// length of the longest common subsequence, in O(min(m,n)) memory
+int lcs_size(const string &x, const string &y){
+  vector<int> row;
+
+  // the row runs along the shorter string
+  if(y.size() > x.size())
+    lcs_row(y, 0, y.size(), x, 0, x.size(), false, row);
+  else
+    lcs_row(x, 0, x.size(), y, 0, y.size(), false, row);
+
+  return row.back();
+}
+
+// appends the LCS of x[xlo, xhi) and y[ylo, yhi) to out. x is split in half;
+// the forward row of the top half and the backward row of the bottom half
+// say where the optimal path crosses the middle, and each side is solved on
+// its own. Only O(n) lengths are live at a time.
+void hirschberg(const string &x, size_t xlo, size_t xhi, const string &y, size_t ylo, size_t yhi, string &out){
+  size_t mid, split = 0;
+  int best = -1;
+
+  if(xhi <= xlo || yhi <= ylo)
+    return;
+
+  if(xhi - xlo == 1){
+    if(find(y.begin() + ylo, y.begin() + yhi, x[xlo]) != y.begin() + yhi)
+      out += x[xlo];
+    return;
+  }
+
+  mid = xlo + (xhi - xlo) / 2;
+  {
+    vector<int> top, bottom;
+
+    lcs_row(x, xlo, mid, y, ylo, yhi, false, top);
+    lcs_row(x, mid, xhi, y, ylo, yhi, true, bottom);
+
+    for(size_t k = 0; k <= yhi - ylo; ++k)
+      if(top[k] + bottom[yhi - ylo - k] > best){
+        best = top[k] + bottom[yhi - ylo - k];
+        split = k;
+      }
+  }
+
+  hirschberg(x, xlo, mid, y, ylo, ylo + split, out);
+  hirschberg(x, mid, xhi, y, ylo + split, yhi, out);
+}
+
+// longest common subsequence in O(m+n) memory and O(mn) time
+string hirschberg_lcs(const string &x, const string &y){
+  string out;
+
+  hirschberg(x, 0, x.size(), y, 0, y.size(), out);
+  return out;
+}
+
+#endif
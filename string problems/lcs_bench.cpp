@@ -0,0 +1,107 @@
+// lcs_bench.cpp
+// author:  Joseph Perry
+// desc:    Measures LCS length throughput: the rolling rows of lcs_size()
+//          against the bit-parallel kernel in lcs_bits.h on one long pair,
+//          and one short query scored against many candidates, one at a time
+//          and with the threaded batch scorer. Then measures filling the full
+//          table for traceback, lcs_length() against LcsTable on one thread
+//          and on every core. A table of side n takes 8n^2 bytes with
+//          lcs_length() and 4n^2 with LcsTable.
+//
+//          usage: ./lcs_bench [length] [candidates] [table side]
+
+#include "lcs.h"
+#include "lcs_bits.h"
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+string random_string(mt19937 &rng, size_t length, int alphabet){
+  string s(length, ' ');
+
+  for(char &c : s)
+    c = 'a' + rng() % alphabet;
+  return s;
+}
+
+// cells is m*n, the table entries a full fill would compute
+void report(const char *name, double cells, chrono::steady_clock::duration elapsed, long checksum){
+  double seconds = chrono::duration<double>(elapsed).count();
+
+  cout << name << ": " << seconds << " s, " << cells / seconds / 1e9 << " Gcells/sec (" << checksum << ")\n";
+}
+
+int main(int argc, char *argv[]){
+  size_t length = argc > 1 ? atol(argv[1]) : 20000;
+  size_t count = argc > 2 ? atol(argv[2]) : 200000;
+  size_t side = argc > 3 ? atol(argv[3]) : 10000;
+  mt19937 rng(1);
+  chrono::steady_clock::time_point start;
+  long checksum;
+
+  string x = random_string(rng, length, 4);
+  string y = random_string(rng, length, 4);
+
+  start = chrono::steady_clock::now();
+  checksum = lcs_size(x, y);
+  report("pair, rolling rows", double(length) * length, chrono::steady_clock::now() - start, checksum);
+
+  start = chrono::steady_clock::now();
+  checksum = LcsQuery(x).score(y);
+  report("pair, bit-parallel", double(length) * length, chrono::steady_clock::now() - start, checksum);
+
+  string query = random_string(rng, 48, 4);
+  vector<string> candidates(count);
+  double cells = 0;
+
+  for(string &c : candidates){
+    c = random_string(rng, 32 + rng() % 32, 4);
+    cells += double(query.size()) * c.size();
+  }
+
+  start = chrono::steady_clock::now();
+  checksum = 0;
+  for(const string &c : candidates)
+    checksum += lcs_size(query, c);
+  report("batch, rolling rows", cells, chrono::steady_clock::now() - start, checksum);
+
+  {
+    LcsQuery q(query);
+
+    start = chrono::steady_clock::now();
+    checksum = 0;
+    for(const string &c : candidates)
+      checksum += q.score(c);
+    report("batch, bit-parallel", cells, chrono::steady_clock::now() - start, checksum);
+  }
+
+  for(unsigned threads : { 1u, 0u }){
+    vector<int> scores;
+
+    start = chrono::steady_clock::now();
+    scores = lcs_scores(query, candidates, threads);
+    checksum = 0;
+    for(int s : scores)
+      checksum += s;
+    report(threads == 1 ? "batch, lcs_scores 1 thread" : "batch, lcs_scores all cores", cells, chrono::steady_clock::now() - start, checksum);
+  }
+
+  x = random_string(rng, side, 4);
+  y = random_string(rng, side, 4);
+  candidates.clear();
+  candidates.shrink_to_fit();
+
+  {
+    start = chrono::steady_clock::now();
+    vector<vector<tuple<int, char>>> table = lcs_length(x, y);
+    report("table, lcs_length", double(side) * side, chrono::steady_clock::now() - start, get<0>(table[side][side]));
+  }
+
+  for(unsigned threads : { 1u, 0u }){
+    start = chrono::steady_clock::now();
+    LcsTable table(x, y, threads);
+    report(threads == 1 ? "table, LcsTable 1 thread" : "table, LcsTable all cores", double(side) * side, chrono::steady_clock::now() - start, table.length());
+  }
+
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+// lcs_bits.h
+// author:  Joseph Perry
+// desc:    Bit-parallel LCS length (Allison-Dix, in Hyyro's form). One bit per
+//          character of the query, so a step along the candidate updates 64
+//          cells of a table row with a handful of word operations. A query
+//          of up to 64 characters fits one word and the batch scorer runs
+//          several candidates side by side; longer queries use several words
+//          with the carry rippled by hand.
+
+#ifndef LCS_BITS_H
+#define LCS_BITS_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+// A query prepared for scoring against any number of candidates
+class LcsQuery {
+  public:
+    // constructor, builds the match masks
+    LcsQuery(const string&);
+
+    // LCS length of the query and a candidate
+    int score(const string&) const;
+
+    // scores for candidates [first, last) into out, four at a time for a short query
+    void score(const vector<string>&, size_t, size_t, vector<int>&) const;
+
+    // getter for the query length
+    size_t inline size() const { return length; }
+
+  private:
+    size_t length;
+    size_t words;
+    vector<uint64_t> masks;                     // masks[c*words + w], bit i set if query[64w+i] == c
+
+    inline const uint64_t* mask(char c) const { return &masks[static_cast<unsigned char>(c) * words]; }
+
+    // single word: runs v over candidate[from, end)
+    uint64_t step(uint64_t, const string&, size_t) const;
+
+    // the query's LCS length given the final row vector, a zero bit is a match
+    int zeros(uint64_t) const;
+    int zeros(const uint64_t*) const;
+};
+
+// constructor
+LcsQuery::LcsQuery(const string &query) : length(query.size()), words((query.size() + 63) / 64) {
+  if(words == 0)
+    words = 1;
+
+  masks.assign(256 * words, 0);
+  for(size_t i = 0; i < length; ++i)
+    masks[static_cast<unsigned char>(query[i]) * words + i / 64] |= uint64_t(1) << (i % 64);
+}
+
+int LcsQuery::zeros(const uint64_t *v) const {
+  int ones = 0;
+
+  if(length == 0)
+    return 0;
+
+  for(size_t w = 0; w < words; ++w){
+    uint64_t valid = w + 1 < words || length % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (length % 64)) - 1;
+    ones += __builtin_popcountll(v[w] & valid);
+  }
+
+  return static_cast<int>(length) - ones;
+}
+
+int LcsQuery::zeros(uint64_t v) const {
+  return zeros(&v);
+}
+
+// per candidate character: u = v & m, v = (v + u) | (v & ~m)
+uint64_t LcsQuery::step(uint64_t v, const string &candidate, size_t from) const {
+  for(size_t j = from; j < candidate.size(); ++j){
+    uint64_t m = *mask(candidate[j]);
+    v = (v + (v & m)) | (v & ~m);
+  }
+
+  return v;
+}
+
+int LcsQuery::score(const string &candidate) const {
+  if(words == 1)
+    return zeros(step(~uint64_t(0), candidate, 0));
+
+  vector<uint64_t> v(words, ~uint64_t(0));
+
+  for(char c : candidate){
+    const uint64_t *m = mask(c);
+    uint64_t carry = 0;
+
+    for(size_t w = 0; w < words; ++w){
+      uint64_t u = v[w] & m[w];
+      uint64_t sum = v[w] + u;
+      uint64_t out = sum < u;
+
+      sum += carry;
+      carry = out | (sum < carry);
+      v[w] = sum | (v[w] & ~m[w]);
+    }
+  }
+
+  return zeros(v.data());
+}
+
+// A single candidate is one long dependency chain through v, so candidates
+// are scored four at a time with their steps interleaved, which keeps the
+// ALUs busy; each one finishes its own tail afterwards. v & ~m is v ^ u.
+void LcsQuery::score(const vector<string> &candidates, size_t first, size_t last, vector<int> &out) const {
+  const uint64_t *m = masks.data();
+
+  if(words == 1){
+    for(; first + 4 <= last; first += 4){
+      const string &s0 = candidates[first], &s1 = candidates[first+1], &s2 = candidates[first+2], &s3 = candidates[first+3];
+      size_t common = min(min(s0.size(), s1.size()), min(s2.size(), s3.size()));
+      uint64_t v0 = ~uint64_t(0), v1 = v0, v2 = v0, v3 = v0;
+      uint64_t u0, u1, u2, u3;
+
+      for(size_t j = 0; j < common; ++j){
+        u0 = v0 & m[static_cast<unsigned char>(s0[j])];
+        u1 = v1 & m[static_cast<unsigned char>(s1[j])];
+        u2 = v2 & m[static_cast<unsigned char>(s2[j])];
+        u3 = v3 & m[static_cast<unsigned char>(s3[j])];
+        v0 = (v0 + u0) | (v0 ^ u0);
+        v1 = (v1 + u1) | (v1 ^ u1);
+        v2 = (v2 + u2) | (v2 ^ u2);
+        v3 = (v3 + u3) | (v3 ^ u3);
+      }
+
+      out[first]   = zeros(step(v0, s0, common));
+      out[first+1] = zeros(step(v1, s1, common));
+      out[first+2] = zeros(step(v2, s2, common));
+      out[first+3] = zeros(step(v3, s3, common));
+    }
+  }
+
+  for(; first < last; ++first)
+    out[first] = score(candidates[first]);
+}
+
+// LCS length of query against every candidate, spread over threads (0 is one per core)
+vector<int> lcs_scores(const string &query, const vector<string> &candidates, unsigned threads = 0){
+  const size_t CHUNK = 64;
+  LcsQuery q(query);
+  vector<int> out(candidates.size());
+  atomic<size_t> next(0);
+  vector<thread> workers;
+
+  if(threads == 0)
+    threads = max(1u, thread::hardware_concurrency());
+  threads = static_cast<unsigned>(min<size_t>(threads, (candidates.size() + CHUNK - 1) / CHUNK));
+
+  // chunks are handed out in order, so long and short candidates even out
+  auto work = [&](){
+    size_t first;
+
+    while((first = next.fetch_add(CHUNK)) < candidates.size())
+      q.score(candidates, first, min(first + CHUNK, candidates.size()), out);
+  };
+
+  for(unsigned t = 1; t < threads; ++t)
+    workers.emplace_back(work);
+  work();
+  for(thread &t : workers)
+    t.join();
+
+  return out;
+}
+
+#endif
@@ -1,42 +1,155 @@
 // palindrome.cpp
 // author:  Joseph Perry
-// desc:    Computes whether a given string or set of strings are palindromes
+// desc:    Computes whether a given string or set of strings are palindromes,
+//          and optionally their longest palindromic substrings, or counts the
+//          palindromes among the lines of a file. Requires C++17.
 
+#include "palindrome_batch.h"
 #include <iostream>
 #include <string>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-using namespace std;
+// A whole file mapped read only, check is_open() before use
+class MappedFile {
+  public:
+    // constructor, maps the file at path
+    MappedFile(const char*);
 
-// computes if the given string is a palindrome
-// returns true if it is, otherwise false
-bool palindrome(string input_string){
-  bool flag = true;
-  size_t length = input_string.length();
+    // destructor, unmaps the file
+    ~MappedFile();
 
-  if(length > 1){
-    if(input_string.front() == input_string.back())
-      flag &= palindrome(input_string.substr(1, length-2));
-    else
-      flag = false;
-  } else {
-    flag = true;
+    bool inline is_open(){ return opened; }
+    string_view inline text(){ return string_view(static_cast<const char*>(data), size); }
+
+  private:
+    void *data;
+    size_t size;
+    bool opened;
+};
+
+// an empty file cannot be mapped, it is open with no text
+MappedFile::MappedFile(const char *path) : data(nullptr), size(0), opened(false) {
+  struct stat st;
+  int fd = open(path, O_RDONLY);
+
+  if(fd < 0)
+    return;
+
+  if(fstat(fd, &st) == 0){
+    opened = true;
+    size = st.st_size;
+    if(size > 0){
+      data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(data == MAP_FAILED){
+        data = nullptr;
+        opened = false;
+      } else {
+        madvise(data, size, MADV_SEQUENTIAL);
+      }
+    }
+  }
+
+  close(fd);
+}
+
+MappedFile::~MappedFile(){
+  if(data != nullptr)
+    munmap(data, size);
+}
+
+// s as the flags compare it, letters folded and whitespace dropped, with at[k]
+// the position in s of the k-th character kept
+string normalize(string_view s, unsigned flags, vector<size_t> &at){
+  string out;
+
+  at.clear();
+  for(size_t i = 0; i < s.size(); ++i){
+    if((flags & Ignore_space) && is_blank(s[i]))
+      continue;
+    out += flags & Ignore_case ? fold_case(s[i]) : s[i];
+    at.push_back(i);
   }
 
-  return flag;
+  return out;
 }
 
+// usage: palindrome [--longest] [--ignore-case] [--ignore-space] strings...
+//        palindrome --batch FILE [--ignore-case] [--ignore-space] [--threads N]
+//   --longest       also print each string's longest palindromic substring and
+//                   how many of its substrings are palindromes, under the same
+//                   flags; the substring is printed as it appears in the string
+//   --ignore-case   compare letters without case
+//   --ignore-space  skip whitespace
+//   --batch         count the palindromes among the lines of FILE
+//   --threads       threads for --batch, default one per core
 int main(int argc, char *argv[]){
   string input_string = "racecar";
+  bool longest = false;
+  unsigned flags = Exact, threads = 0;
+  const char *batch = nullptr;
+  vector<char*> rest;
 
-  if(argc > 1)
-    for(int i = 1; i < argc; ++i){
-      input_string = argv[i];
+  for(int i = 1; i < argc; ++i){
+    if(strcmp(argv[i], "--longest") == 0)
+      longest = true;
+    else if(strcmp(argv[i], "--ignore-case") == 0)
+      flags |= Ignore_case;
+    else if(strcmp(argv[i], "--ignore-space") == 0)
+      flags |= Ignore_space;
+    else if(strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+      batch = argv[++i];
+    else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+      threads = atoi(argv[++i]);
+    else
+      rest.push_back(argv[i]);
+  }
+
+  if(batch != nullptr){
+    MappedFile file(batch);
 
-      if(palindrome(input_string))
-        cout << input_string << " is a palindrome" << endl;
-      else
-        cout << input_string << " is not a palindrome" << endl;
+    if(!file.is_open()){
+      cerr << "cannot read " << batch << endl;
+      return 1;
     }
 
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    PalindromeCount count = count_palindromes(file.text(), flags, threads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << count.tokens << " tokens, " << count.palindromes << " palindromes in " << seconds << " s, "
+         << count.tokens / seconds << " tokens/sec" << endl;
+    return 0;
+  }
+
+  for(char *arg : rest){
+    input_string = arg;
+
+    if(palindrome(input_string, flags))
+      cout << input_string << " is a palindrome" << endl;
+    else
+      cout << input_string << " is not a palindrome" << endl;
+
+    if(longest){
+      vector<size_t> at;
+      string text = normalize(input_string, flags, at);
+      Manacher engine(text);
+      string_view best = engine.longest(), original;
+
+      // from the first to the last character of the match, whitespace between included
+      if(!best.empty()){
+        size_t first = at[best.data() - text.data()], last = at[best.data() - text.data() + best.size() - 1];
+        original = string_view(input_string).substr(first, last - first + 1);
+      }
+
+      cout << "  longest: " << original << ", palindromic substrings: " << engine.count() << endl;
+    }
+  }
+
   return 0;
 }
\ No newline at end of file
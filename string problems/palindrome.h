@@ -0,0 +1,126 @@
+// palindrome.h
+// author:  Joseph Perry
+// desc:    Palindrome checks in linear time. palindrome() compares the two ends
+//          of a string_view towards the middle, with no copies. Manacher finds
+//          every palindrome centred at every position in one pass, which
+//          answers the longest palindromic substring, the number of
+//          palindromic substrings and whether any substring is a palindrome.
+//          Requires C++17.
+
+#ifndef PALINDROME_H
+#define PALINDROME_H
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+// computes if the given string is a palindrome
+// returns true if it is, otherwise false
+bool palindrome(string_view s){
+  size_t i = 0, j = s.size();
+
+  while(i + 1 < j){
+    if(s[i] != s[j-1])
+      return false;
+    ++i;
+    --j;
+  }
+
+  return true;
+}
+
+// Palindromic radii of a string, the string must outlive the engine
+class Manacher {
+  public:
+    // constructor, computes the radii in O(n)
+    Manacher(string_view);
+
+    // the longest palindromic substring, the leftmost if there are several
+    string_view longest() const;
+
+    // number of palindromic substrings, counted by position
+    uint64_t count() const;
+
+    // whether s[pos, pos+length) is a palindrome, in O(1)
+    bool is_palindrome(size_t, size_t) const;
+
+  private:
+    string_view s;
+    vector<size_t> odd;                     // odd[i]: s[i-k+1, i+k) is a palindrome for every k <= odd[i]
+    vector<size_t> even;                    // even[i]: s[i-k, i+k) is a palindrome for every k <= even[i]
+};
+
+// the palindrome reaching furthest right, [l, r), mirrors radii from its left
+// half into its right half, so each character is compared O(1) times overall
+Manacher::Manacher(string_view s) : s(s), odd(s.size()), even(s.size()) {
+  size_t n = s.size();
+  size_t l = 0, r = 0;
+
+  for(size_t i = 0; i < n; ++i){
+    size_t k = i < r ? min(odd[l + r - 1 - i], r - i) : 1;
+
+    while(k <= i && i + k < n && s[i-k] == s[i+k])
+      ++k;
+    odd[i] = k;
+    if(i + k > r){
+      l = i + 1 - k;
+      r = i + k;
+    }
+  }
+
+  l = r = 0;
+  for(size_t i = 0; i < n; ++i){
+    size_t k = i < r ? min(even[l + r - i], r - i) : 0;
+
+    while(k < i && i + k < n && s[i-k-1] == s[i+k])
+      ++k;
+    even[i] = k;
+    if(i + k > r){
+      l = i - k;
+      r = i + k;
+    }
+  }
+}
+
+string_view Manacher::longest() const {
+  size_t pos = 0, length = 0;
+
+  for(size_t i = 0; i < s.size(); ++i){
+    if(2*odd[i] - 1 > length){
+      length = 2*odd[i] - 1;
+      pos = i + 1 - odd[i];
+    }
+    if(2*even[i] > length){
+      length = 2*even[i];
+      pos = i - even[i];
+    }
+  }
+
+  return s.substr(pos, length);
+}
+
+uint64_t Manacher::count() const {
+  uint64_t total = 0;
+
+  for(size_t i = 0; i < s.size(); ++i)
+    total += odd[i] + even[i];
+
+  return total;
+}
+
+// the substring's centre is a character for an odd length, a gap for an even one
+bool Manacher::is_palindrome(size_t pos, size_t length) const {
+  if(length == 0)
+    return pos <= s.size();
+  if(pos + length > s.size())
+    return false;
+
+  if(length % 2 == 1)
+    return odd[pos + length/2] >= (length + 1) / 2;
+  return even[pos + length/2] >= length / 2;
+}
+
+#endif
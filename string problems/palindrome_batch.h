@@ -0,0 +1,216 @@
+// palindrome_batch.h
+// author:  Joseph Perry
+// desc:    Classifies every line of a large buffer as a palindrome or not,
+//          across threads. With SSSE3 a token shorter than 16 bytes is checked
+//          with one byte shuffle that reverses it in a register and one
+//          compare; longer tokens compare 16-byte blocks from the front
+//          against reversed blocks from the back. Case folding is done on the
+//          same registers. Ignoring whitespace changes which characters pair
+//          up, so a token with whitespace finishes on the scalar path.
+//          Requires C++17.
+
+#ifndef PALINDROME_BATCH_H
+#define PALINDROME_BATCH_H
+
+#include "palindrome.h"
+#include <thread>
+#include <cstring>
+#if defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+enum Palindrome_flags : unsigned { Exact = 0, Ignore_case = 1, Ignore_space = 2 };
+
+inline bool is_blank(char c){ return c == ' ' || (c >= '\t' && c <= '\r'); }
+inline char fold_case(char c){ return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c; }
+
+// as palindrome(), optionally comparing letters without case and skipping whitespace
+bool palindrome(string_view s, unsigned flags){
+  size_t i = 0, j = s.size();
+
+  while(true){
+    if(flags & Ignore_space){
+      while(i < j && is_blank(s[i]))
+        ++i;
+      while(j > i && is_blank(s[j-1]))
+        --j;
+    }
+    if(i + 1 >= j)
+      return true;
+
+    char a = s[i], b = s[j-1];
+    if(flags & Ignore_case){
+      a = fold_case(a);
+      b = fold_case(b);
+    }
+    if(a != b)
+      return false;
+    ++i;
+    --j;
+  }
+}
+
+#if defined(__SSSE3__)
+// shuffle control reversing the first n bytes of a register
+const __m128i& reverse_mask(size_t n){
+  struct Masks {
+    __m128i m[17];
+
+    Masks(){
+      for(int n = 0; n <= 16; ++n){
+        alignas(16) char b[16];
+        for(int k = 0; k < 16; ++k)
+          b[k] = k < n ? static_cast<char>(n - 1 - k) : static_cast<char>(0x80);
+        m[n] = _mm_load_si128(reinterpret_cast<const __m128i*>(b));
+      }
+    }
+  };
+  static const Masks masks;
+
+  return masks.m[n];
+}
+
+// bit k set if byte k is whitespace
+inline unsigned blanks(__m128i v){
+  __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+  __m128i control = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)));
+
+  return _mm_movemask_epi8(_mm_or_si128(space, control));
+}
+
+// bytes above 0x7f are negative here, so they are never in range
+inline __m128i fold_case(__m128i v){
+  __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+
+  return _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+}
+#endif
+
+// as palindrome(s, flags); readable is how many bytes from s.data() may be
+// loaded, so a short token can be read as a whole register
+bool palindrome_vector(string_view s, unsigned flags = Exact, size_t readable = 0){
+#if defined(__SSSE3__)
+  size_t n = s.size(), i = 0, j = n;
+
+  if(n < 16){
+    alignas(16) char b[16];
+    __m128i v;
+    unsigned need = (1u << n) - 1;
+
+    if(readable >= 16){
+      v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data()));
+    } else {
+      memcpy(b, s.data(), n);
+      v = _mm_load_si128(reinterpret_cast<const __m128i*>(b));
+    }
+
+    if((flags & Ignore_space) && (blanks(v) & need))
+      return palindrome(s, flags);
+    if(flags & Ignore_case)
+      v = fold_case(v);
+
+    return (_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_shuffle_epi8(v, reverse_mask(n)))) & need) == need;
+  }
+
+  // block [i, i+16) against block [j-16, j) reversed checks the pairs
+  // (i+k, j-1-k); the last two blocks may overlap, which only repeats pairs
+  while(i + 1 < j){
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data() + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data() + j - 16));
+
+    if((flags & Ignore_space) && (blanks(a) || blanks(b)))
+      return palindrome(s.substr(i, j - i), flags);
+    if(flags & Ignore_case){
+      a = fold_case(a);
+      b = fold_case(b);
+    }
+    if(_mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_shuffle_epi8(b, reverse_mask(16)))) != 0xFFFF)
+      return false;
+
+    i += 16;
+    j -= 16;
+  }
+
+  return true;
+#else
+  (void)readable;
+  return palindrome(s, flags);
+#endif
+}
+
+struct PalindromeCount {
+  uint64_t tokens;
+  uint64_t palindromes;
+};
+
+// one token per line, a \r before the \n is not part of it; marks, if given,
+// gets 1 or 0 per token in order. threads 0 is one per core
+PalindromeCount count_palindromes(string_view text, unsigned flags = Exact, unsigned threads = 0, vector<uint8_t> *marks = nullptr){
+  vector<PalindromeCount> counts;
+  vector<vector<uint8_t>> slice_marks;
+  vector<size_t> starts;
+  vector<thread> workers;
+  PalindromeCount total = { 0, 0 };
+
+  if(threads == 0)
+    threads = max(1u, thread::hardware_concurrency());
+  threads = static_cast<unsigned>(max<size_t>(1, min<size_t>(threads, text.size() / 4096)));
+
+  // slices start at line starts
+  starts.push_back(0);
+  for(unsigned t = 1; t < threads; ++t){
+    size_t at = text.find('\n', max(starts.back(), text.size() * t / threads));
+    if(at == string_view::npos)
+      break;
+    starts.push_back(at + 1);
+  }
+  starts.push_back(text.size());
+
+  counts.assign(starts.size() - 1, PalindromeCount{ 0, 0 });
+  slice_marks.resize(marks != nullptr ? starts.size() - 1 : 0);
+
+  auto work = [&](size_t slice){
+    const char *p = text.data() + starts[slice], *end = text.data() + starts[slice + 1];
+    const char *buffer_end = text.data() + text.size();
+    PalindromeCount count = { 0, 0 };
+
+    while(p < end){
+      const char *q = static_cast<const char*>(memchr(p, '\n', end - p));
+      const char *next = q != nullptr ? q + 1 : end;
+
+      if(q == nullptr)
+        q = end;
+      if(q > p && q[-1] == '\r')
+        --q;
+
+      bool yes = palindrome_vector(string_view(p, q - p), flags, buffer_end - p);
+      count.tokens++;
+      count.palindromes += yes;
+      if(marks != nullptr)
+        slice_marks[slice].push_back(yes);
+
+      p = next;
+    }
+
+    counts[slice] = count;
+  };
+
+  for(size_t s = 1; s < counts.size(); ++s)
+    workers.emplace_back(work, s);
+  work(0);
+  for(thread &w : workers)
+    w.join();
+
+  if(marks != nullptr)
+    marks->clear();
+  for(size_t s = 0; s < counts.size(); ++s){
+    total.tokens += counts[s].tokens;
+    total.palindromes += counts[s].palindromes;
+    if(marks != nullptr)
+      marks->insert(marks->end(), slice_marks[s].begin(), slice_marks[s].end());
+  }
+
+  return total;
+}
+
+#endif
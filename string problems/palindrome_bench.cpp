@@ -0,0 +1,114 @@
+// palindrome_bench.cpp
+// author:  Joseph Perry
+// desc:    Measures the palindrome checks in palindrome.h on multi-megabyte
+//          inputs: the recursive substr check this directory used to have
+//          against the two-pointer palindrome(), and Manacher against
+//          expanding around every centre, on random text and on a run of one
+//          character, the worst case for expanding. Then classifies a buffer
+//          of short tokens one line at a time with palindrome() against
+//          count_palindromes() on one thread and on every core. Build with
+//          -O2 -march=native for the vector path. Requires C++17.
+//
+//          usage: ./palindrome_bench [megabytes]
+
+#include "palindrome_batch.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+// the original check, one substr copy per level of recursion
+bool palindrome_recursive(string input_string){
+  size_t length = input_string.length();
+
+  if(length > 1){
+    if(input_string.front() == input_string.back())
+      return palindrome_recursive(input_string.substr(1, length-2));
+    return false;
+  }
+
+  return true;
+}
+
+// number of palindromic substrings by growing each centre until it breaks, O(n^2) worst case
+uint64_t count_by_expanding(string_view s){
+  uint64_t total = 0;
+
+  for(size_t c = 0; c < 2 * s.size(); ++c){
+    size_t l = c / 2, r = l + c % 2;
+
+    while(r < s.size() && s[l] == s[r]){
+      ++total;
+      if(l == 0)
+        break;
+      --l;
+      ++r;
+    }
+  }
+
+  return total;
+}
+
+template <typename F>
+void report(const char *name, size_t bytes, F f){
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  uint64_t result = f();
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  cout << name << ": " << bytes << " bytes in " << seconds << " s, " << bytes / seconds / 1e6 << " MB/sec (" << result << ")\n";
+}
+
+int main(int argc, char *argv[]){
+  size_t bytes = (argc > 1 ? atol(argv[1]) : 8) << 20;
+  size_t small = 20000;                     // the recursive check runs out of stack much past this
+  mt19937 rng(1);
+  string text(bytes, ' ');
+
+  for(char &c : text)
+    c = 'a' + rng() % 4;
+
+  // a palindrome, so both checks walk the whole string
+  string mirrored = text.substr(0, bytes / 2);
+  mirrored.append(mirrored.rbegin(), mirrored.rend());
+
+  report("recursive substr, palindrome", small, [&](){ return palindrome_recursive(mirrored.substr(0, small / 2) + mirrored.substr(bytes - small / 2)); });
+  report("two-pointer, palindrome", bytes, [&](){ return palindrome(mirrored); });
+
+  report("expanding, random text", bytes, [&](){ return count_by_expanding(text); });
+  report("Manacher, random text", bytes, [&](){ return Manacher(text).count(); });
+
+  string run(small * 4, 'a');
+  report("expanding, one character", run.size(), [&](){ return count_by_expanding(run); });
+  run.assign(bytes, 'a');
+  report("Manacher, one character", bytes, [&](){ return Manacher(run).count(); });
+  run.clear();
+  run.shrink_to_fit();
+
+  // short tokens, half of them palindromes
+  string tokens;
+  while(tokens.size() < bytes){
+    size_t n = 1 + rng() % 24;
+    string t = text.substr(rng() % (bytes - n), n);
+
+    if(rng() % 2)
+      t.replace(n - n/2, n/2, string(t.rbegin() + (n - n/2), t.rend()));
+    tokens += t;
+    tokens += '\n';
+  }
+
+  report("palindrome() per line, tokens", tokens.size(), [&](){
+    uint64_t found = 0;
+    size_t p = 0, q;
+
+    while((q = tokens.find('\n', p)) != string::npos){
+      found += palindrome(string_view(tokens).substr(p, q - p));
+      p = q + 1;
+    }
+    return found;
+  });
+  report("count_palindromes 1 thread, tokens", tokens.size(), [&](){ return count_palindromes(tokens, Exact, 1).palindromes; });
+  report("count_palindromes all cores, tokens", tokens.size(), [&](){ return count_palindromes(tokens, Exact, 0).palindromes; });
+
+  return 0;
+}
\ No newline at end of file
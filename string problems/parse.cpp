@@ -1,50 +1,65 @@
 // parse.cpp
 // author:  Joseph Perry
-// desc:    Parses a string formatted as a valid set of URL GETs into a map of key:value pairs
+// desc:    Parses a string formatted as a valid set of URL GETs into key:value pairs,
+//          or a form body as it streams in (see parse.h). Requires C++17.
 
-#include <iostream>
-#include <map>
+#include "parse.h"
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
 
-using namespace std;
+// reads a form body from in a chunk at a time, printing each pair as it is found
+bool parse_stream(istream &in, size_t chunk_size){
+  vector<char> chunk(chunk_size);
+  FormParser parser([](const QueryParam &p){ cout << p.key.decoded() << ": " << p.value.decoded() << "\n"; });
 
-// assuming input_string is properly formatted
-map<string, string> parse(string input_string){
-  map<string, string> result;
-  string key, value;
-  
-  int offset = 0;
-  int amp_pos = 0;
-  int equ_pos = 0;
-
-  while(amp_pos != string::npos){
-    equ_pos = input_string.find('=', offset);
-    amp_pos = input_string.find('&', offset);
+  while(in){
+    in.read(chunk.data(), chunk.size());
+    if(!parser.feed(string_view(chunk.data(), in.gcount())))
+      break;
+  }
 
-    // key is found [offset, equ_pos)
-    key = input_string.substr(offset, equ_pos - offset);
+  return parser.finish();
+}
 
-    // value is found [equ_pos + 1, amp_pos)
-    value = input_string.substr(equ_pos + 1, amp_pos - equ_pos - 1);
+// usage: parse [query]
+//        parse --stream FILE [--chunk BYTES]
+//   --stream  parse a form body from FILE, - for stdin, as it is read
+//   --chunk   bytes read at a time, default 65536
+int main(int argc, char *argv[]){
+  string query = "key1=value1&key2=value2&key3=value3";
+  const char *stream = nullptr;
+  size_t chunk_size = 65536;
 
-    if(key.compare("") == 0)
-      break;
-
-    result[key] = value;
-    offset = amp_pos + 1;
+  for(int i = 1; i < argc; ++i){
+    if(strcmp(argv[i], "--stream") == 0 && i + 1 < argc)
+      stream = argv[++i];
+    else if(strcmp(argv[i], "--chunk") == 0 && i + 1 < argc)
+      chunk_size = max(1L, atol(argv[++i]));
+    else
+      query = argv[i];
   }
 
-  return result;
-}
+  if(stream != nullptr){
+    ifstream file;
 
-void print_result(map<string, string> result){
-  for(auto res : result)
-    cout << res.first << ": " << res.second << endl;  
-}
+    if(strcmp(stream, "-") != 0){
+      file.open(stream, ios::binary);
+      if(!file){
+        cerr << "cannot read " << stream << endl;
+        return 1;
+      }
+    }
 
-int main(){
-  map<string, string> result = parse("key1=value1&key2=value2&key3=value3");
+    if(!parse_stream(file.is_open() ? file : cin, chunk_size)){
+      cerr << "a pair is longer than the limit" << endl;
+      return 1;
+    }
+    return 0;
+  }
 
-  print_result(result);
+  for(const QueryParam &p : QueryString(query))
+    cout << p.key.decoded() << ": " << p.value.decoded() << endl;
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,467 @@
+// parse.h
+// author:  Joseph Perry
+// desc:    Parses URL query strings (application/x-www-form-urlencoded) into
+//          key:value pairs. parse() builds a map of copies; QueryString keeps
+//          string_views into the caller's buffer, in order, and only decodes
+//          percent escapes and '+' when a key or value is asked for. Short
+//          pairs are split 64 bytes at a time with SSE2 or AVX2 compares where
+//          available, long keys and values are skipped with memchr.
+//          FormParser does the same for a body arriving in chunks, holding on
+//          to at most one pair. Requires C++17.
+
+#ifndef PARSE_H
+#define PARSE_H
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <map>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// assuming input_string is properly formatted
+map<string, string> parse(string input_string){
+  map<string, string> result;
+  string key, value;
+  
+  size_t offset = 0;
+  size_t amp_pos = 0;
+  size_t equ_pos = 0;
+
+  while(amp_pos != string::npos){
+    equ_pos = input_string.find('=', offset);
+    amp_pos = input_string.find('&', offset);
+
+    // key is found [offset, equ_pos)
+    key = input_string.substr(offset, equ_pos - offset);
+
+    // value is found [equ_pos + 1, amp_pos)
+    value = input_string.substr(equ_pos + 1, amp_pos - equ_pos - 1);
+
+    if(key.compare("") == 0)
+      break;
+
+    result[key] = value;
+    offset = amp_pos + 1;
+  }
+
+  return result;
+}
+
+void print_result(map<string, string> result){
+  for(auto res : result)
+    cout << res.first << ": " << res.second << endl;  
+}
+
+// bits k set in amp and equ where p[k] is '&' and '=', for the first n <= 64 bytes
+inline void delimiters_scalar(const char *p, size_t n, uint64_t &amp, uint64_t &equ){
+  amp = equ = 0;
+
+  for(size_t k = 0; k < n; ++k){
+    amp |= static_cast<uint64_t>(p[k] == '&') << k;
+    equ |= static_cast<uint64_t>(p[k] == '=') << k;
+  }
+}
+
+// as delimiters_scalar() for a whole 64-byte block, with four 16-byte or two
+// 32-byte compares per delimiter
+inline void delimiters(const char *p, uint64_t &amp, uint64_t &equ){
+#if defined(__AVX2__)
+  __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+  __m256i a = _mm256_set1_epi8('&'), e = _mm256_set1_epi8('=');
+
+  amp = static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, a)))) << 32
+      | static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, a)));
+  equ = static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, e)))) << 32
+      | static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, e)));
+#elif defined(__SSE2__)
+  __m128i a = _mm_set1_epi8('&'), e = _mm_set1_epi8('=');
+  __m128i amps[4], equs[4];
+
+  for(int k = 0; k < 4; ++k){
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16*k));
+    amps[k] = _mm_cmpeq_epi8(v, a);
+    equs[k] = _mm_cmpeq_epi8(v, e);
+  }
+
+  // a block inside a long value has no delimiters, one movemask says so
+  amp = equ = 0;
+  if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_or_si128(amps[0], amps[1]), _mm_or_si128(amps[2], amps[3])),
+                                    _mm_or_si128(_mm_or_si128(equs[0], equs[1]), _mm_or_si128(equs[2], equs[3])))) == 0)
+    return;
+
+  for(int k = 0; k < 4; ++k){
+    amp |= static_cast<uint64_t>(_mm_movemask_epi8(amps[k])) << (16*k);
+    equ |= static_cast<uint64_t>(_mm_movemask_epi8(equs[k])) << (16*k);
+  }
+#else
+  delimiters_scalar(p, 64, amp, equ);
+#endif
+}
+
+// value of a hex digit, -1 if c is not one
+inline int hex_value(char c){
+  if(c >= '0' && c <= '9')
+    return c - '0';
+  if(c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if(c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// A percent-encoded piece of the original buffer, decoded on access. '+' is
+// a space and %XX a byte; a '%' not followed by two hex digits is kept as is
+class Encoded {
+  public:
+    // constructor
+    Encoded(string_view raw = string_view()) : text(raw) {}
+
+    // getter for the bytes as they appear in the buffer
+    string_view inline raw() const { return text; }
+
+    // whether decoding would change anything
+    bool inline escaped() const { return text.find_first_of("%+") != string_view::npos; }
+
+    // appends the decoded bytes to out
+    void decode(string&) const;
+
+    // the decoded bytes
+    string decoded() const;
+
+    // compares the decoded bytes with s without allocating
+    bool operator==(string_view) const;
+
+  private:
+    string_view text;
+
+    // decodes the byte at i and returns where the next one starts
+    size_t next(size_t, char&) const;
+};
+
+size_t Encoded::next(size_t i, char &c) const {
+  if(text[i] == '+'){
+    c = ' ';
+    return i + 1;
+  }
+
+  if(text[i] == '%' && i + 2 < text.size() && hex_value(text[i+1]) >= 0 && hex_value(text[i+2]) >= 0){
+    c = static_cast<char>(hex_value(text[i+1]) * 16 + hex_value(text[i+2]));
+    return i + 3;
+  }
+
+  c = text[i];
+  return i + 1;
+}
+
+void Encoded::decode(string &out) const {
+  char c;
+
+  for(size_t i = 0; i < text.size(); ){
+    i = next(i, c);
+    out += c;
+  }
+}
+
+string Encoded::decoded() const {
+  string out;
+
+  out.reserve(text.size());
+  decode(out);
+  return out;
+}
+
+// decoding never makes text longer, and most keys differ in their first byte
+bool Encoded::operator==(string_view s) const {
+  size_t i = 0, j = 0;
+  char c;
+
+  if(text.size() < s.size())
+    return false;
+  if(!s.empty() && text[0] != s[0] && text[0] != '%' && text[0] != '+')
+    return false;
+
+  for(; i < text.size() && j < s.size(); ++j){
+    i = next(i, c);
+    if(c != s[j])
+      return false;
+  }
+
+  return i == text.size() && j == s.size();
+}
+
+struct QueryParam {
+  Encoded key;
+  Encoded value;
+  bool has_value;                       // "key=" has an empty value, "key" has none
+};
+
+// The pairs of a query string, in order, viewing the buffer passed to the
+// constructor, which must outlive it. Repeated keys are all kept; empty
+// pairs ("a=1&&b=2") are skipped and a leading '?' is ignored
+class QueryString {
+  public:
+    // constructor, parses query
+    QueryString(string_view = string_view());
+
+    // parses query in place of the current pairs, reusing their storage
+    void assign(string_view);
+
+    // adds the pairs of a piece of a query after the current ones, a leading '?' is part of the first key
+    void append(string_view);
+
+    // removes every pair, keeping their storage
+    void inline clear(){ params.clear(); }
+
+    size_t inline size() const { return params.size(); }
+    const QueryParam& operator[](size_t i) const { return params[i]; }
+    vector<QueryParam>::const_iterator begin() const { return params.begin(); }
+    vector<QueryParam>::const_iterator end() const { return params.end(); }
+
+    // the first pair whose decoded key is key, nullptr if there is none
+    const QueryParam* find(string_view) const;
+
+    // the values of every pair whose decoded key is key, in order
+    vector<Encoded> all(string_view) const;
+
+  private:
+    vector<QueryParam> params;
+
+    // adds the pair p[from, to) whose first '=' is at equ, npos for none
+    void add(const char*, size_t, size_t, size_t);
+
+    // finds where the pair running through p[at] ends, with memchr
+    static size_t pair_end(const char*, size_t, size_t, size_t&);
+};
+
+// constructor
+QueryString::QueryString(string_view query){
+  assign(query);
+}
+
+void QueryString::assign(string_view query){
+  params.clear();
+
+  if(!query.empty() && query[0] == '?')
+    query.remove_prefix(1);
+  append(query);
+}
+
+// Where pairs are short, 64-byte blocks are scanned for both delimiters at
+// once and the pairs read off the bits: each '&' ends a pair, whose key ends
+// at the first '=' after the pair's start. A block with neither is inside a
+// long key or value, so the rest of that pair is left to memchr, which is
+// faster over long runs, and so are the pairs after it until one is shorter
+// than a block again, and the last partial block.
+void QueryString::append(string_view query){
+  const char *p = query.data();
+  size_t n = query.size(), from = 0, equ = string_view::npos, at = 0;
+  bool sparse = false;
+
+  while(at < n){
+    if(sparse || at + 64 > n){
+      at = pair_end(p, at, n, equ);
+      if(at == n)
+        break;
+      add(p, from, at, equ);
+      sparse = at - from >= 64;
+      from = ++at;
+      equ = string_view::npos;
+      continue;
+    }
+
+    uint64_t amp_bits, equ_bits;
+
+    delimiters(p + at, amp_bits, equ_bits);
+
+    if((amp_bits | equ_bits) == 0){
+      at = pair_end(p, at + 64, n, equ);
+      if(at == n)
+        break;
+      add(p, from, at, equ);
+      sparse = true;
+      from = ++at;
+      equ = string_view::npos;
+      continue;
+    }
+
+    while(amp_bits != 0){
+      size_t end = at + __builtin_ctzll(amp_bits);
+      uint64_t before = equ_bits & ((amp_bits & -amp_bits) - 1);
+
+      if(equ == string_view::npos && before != 0)
+        equ = at + __builtin_ctzll(before);
+      add(p, from, end, equ);
+
+      from = end + 1;
+      equ = string_view::npos;
+      equ_bits &= ~((amp_bits & -amp_bits) - 1);
+      amp_bits &= amp_bits - 1;
+    }
+
+    if(equ == string_view::npos && equ_bits != 0)
+      equ = at + __builtin_ctzll(equ_bits);
+    at += 64;
+  }
+
+  add(p, from, n, equ);
+}
+
+// the next '&' in p[at, n), n if there is none; sets equ to the first '='
+// before it if equ is still npos
+inline size_t QueryString::pair_end(const char *p, size_t at, size_t n, size_t &equ){
+  const char *amp = static_cast<const char*>(memchr(p + at, '&', n - at));
+  size_t end = amp != nullptr ? amp - p : n;
+
+  if(equ == string_view::npos){
+    const char *e = static_cast<const char*>(memchr(p + at, '=', end - at));
+    if(e != nullptr)
+      equ = e - p;
+  }
+
+  return end;
+}
+
+// empty pairs are skipped, inlined into the scan
+inline void QueryString::add(const char *p, size_t from, size_t to, size_t equ){
+  if(from == to)
+    return;
+
+  if(equ == string_view::npos)
+    params.push_back(QueryParam{ Encoded(string_view(p + from, to - from)), Encoded(), false });
+  else
+    params.push_back(QueryParam{ Encoded(string_view(p + from, equ - from)), Encoded(string_view(p + equ + 1, to - equ - 1)), true });
+}
+
+const QueryParam* QueryString::find(string_view key) const {
+  for(const QueryParam &p : params)
+    if(p.key == key)
+      return &p;
+
+  return nullptr;
+}
+
+vector<Encoded> QueryString::all(string_view key) const {
+  vector<Encoded> values;
+
+  for(const QueryParam &p : params)
+    if(p.key == key)
+      values.push_back(p.value);
+
+  return values;
+}
+
+// Parses an application/x-www-form-urlencoded body pushed in chunks of any
+// size, calling the handler with each pair in order. Pairs inside a chunk are
+// passed as views into it; only a pair cut by a chunk boundary is copied, so
+// memory stays bounded by the longest pair, which is capped at max_pair.
+// Unlike QueryString a leading '?' is not skipped
+class FormParser {
+  public:
+    // the pair's views are only valid during the call
+    typedef function<void(const QueryParam&)> Handler;
+
+    // constructor, pairs longer than max_pair bytes are an error
+    FormParser(Handler, size_t = 1 << 20);
+
+    // parses the next chunk, false once a pair is longer than max_pair; the rest of the body is then ignored
+    bool feed(string_view);
+
+    // the body has ended, passes on the last pair and readies the parser for another body
+    bool finish();
+
+    // getter for the bytes held back for a pair that spans chunks
+    size_t inline buffered() const { return partial.size(); }
+
+  private:
+    Handler handler;
+    size_t max_pair;
+    string partial;                       // the start of a pair whose end has not arrived
+    QueryString pairs;                    // reused for every chunk
+    bool failed;
+
+    // passes on every pair in text, which has no pair cut short, false at a
+    // pair longer than max_pair
+    bool emit(string_view);
+};
+
+// constructor
+FormParser::FormParser(Handler handler, size_t max_pair) : handler(handler), max_pair(max_pair), failed(false) {}
+
+bool FormParser::feed(string_view chunk){
+  size_t amp, last;
+
+  if(failed)
+    return false;
+
+  amp = chunk.find('&');
+  if(partial.size() + min(amp, chunk.size()) > max_pair){
+    failed = true;
+    partial.clear();
+    return false;
+  }
+
+  if(amp == string_view::npos){
+    partial.append(chunk.data(), chunk.size());
+    return true;
+  }
+
+  // the pair carried over from earlier chunks ends here
+  if(!partial.empty()){
+    partial.append(chunk.data(), amp);
+    emit(partial);
+    partial.clear();
+  } else {
+    emit(chunk.substr(0, amp));
+  }
+  chunk.remove_prefix(amp + 1);
+
+  last = chunk.rfind('&');
+  if(last != string_view::npos && !emit(chunk.substr(0, last))){
+    failed = true;
+    return false;
+  }
+  if(last != string_view::npos)
+    chunk.remove_prefix(last + 1);
+
+  if(chunk.size() > max_pair){
+    failed = true;
+    return false;
+  }
+  partial.assign(chunk.data(), chunk.size());
+  return true;
+}
+
+bool FormParser::finish(){
+  bool ok = !failed && emit(partial);
+
+  partial.clear();
+  failed = false;
+  return ok;
+}
+
+bool FormParser::emit(string_view text){
+  pairs.clear();
+  pairs.append(text);
+
+  for(const QueryParam &p : pairs){
+    size_t length = p.key.raw().size() + (p.has_value ? 1 + p.value.raw().size() : 0);
+
+    if(length > max_pair)
+      return false;
+    handler(p);
+  }
+
+  return true;
+}
+
+#endif
@@ -0,0 +1,167 @@
+// parse_fuzz.cpp
+// author:  Joseph Perry
+// desc:    Random testing of the query string parser in parse.h. Checks the
+//          vector delimiter scan against the scalar one, QueryString against
+//          parse() on well-formed queries, where parse() is right, and
+//          QueryString against a plain find('&')/find('=') splitter on
+//          arbitrary bytes, and FormParser fed in random chunks against
+//          QueryString on the whole body. Prints the first failing query.
+//          Requires C++17.
+//
+//          usage: ./parse_fuzz [iterations] [seed]
+
+#include "parse.h"
+#include <random>
+#include <cstdlib>
+#include <cstring>
+
+// the pairs split one find() at a time, with the same rules as QueryString
+vector<pair<string, string>> split_pairs(string_view query){
+  vector<pair<string, string>> pairs;
+
+  if(!query.empty() && query[0] == '?')
+    query.remove_prefix(1);
+
+  while(true){
+    size_t amp = query.find('&');
+    string_view p = query.substr(0, amp);
+    size_t equ = p.find('=');
+
+    if(!p.empty())
+      pairs.push_back(make_pair(string(p.substr(0, equ)), equ == string_view::npos ? "\x01" : string(p.substr(equ + 1))));
+
+    if(amp == string_view::npos)
+      return pairs;
+    query.remove_prefix(amp + 1);
+  }
+}
+
+vector<pair<string, string>> query_pairs(const QueryString &qs){
+  vector<pair<string, string>> pairs;
+
+  for(const QueryParam &p : qs)
+    pairs.push_back(make_pair(string(p.key.raw()), p.has_value ? string(p.value.raw()) : "\x01"));
+
+  return pairs;
+}
+
+string random_text(mt19937 &rng, const char *alphabet, size_t min_length, size_t max_length){
+  size_t n = min_length + rng() % (max_length - min_length + 1);
+  size_t letters = strlen(alphabet);
+  string s(n, ' ');
+
+  for(char &c : s)
+    c = alphabet[rng() % letters];
+  return s;
+}
+
+bool fail(const char *what, const string &query){
+  cout << what << " failed on \"" << query << "\"" << endl;
+  return false;
+}
+
+// a well-formed query: non-empty keys without '&' or '=', every pair has an '='
+bool well_formed_case(mt19937 &rng){
+  string query;
+  size_t pairs = 1 + rng() % 12;
+
+  for(size_t i = 0; i < pairs; ++i){
+    if(i > 0)
+      query += '&';
+    query += random_text(rng, "abk%2+", 1, 6) + "=" + random_text(rng, "xy%3D+=", 0, 80);
+  }
+
+  // parse() keeps the last value of a repeated key
+  map<string, string> expected = parse(query), got;
+  for(const QueryParam &p : QueryString(query))
+    got[string(p.key.raw())] = string(p.value.raw());
+
+  return got == expected || fail("parse()", query);
+}
+
+// short runs of arbitrary bytes, some joined by long runs without delimiters
+// so whole blocks are skipped
+bool arbitrary_case(mt19937 &rng){
+  string query = random_text(rng, "a&=?%+", 0, 200);
+
+  for(int k = rng() % 4; k > 0; --k)
+    query += random_text(rng, "ab", 0, 300) + random_text(rng, "a&=?%+", 0, 40);
+
+  return query_pairs(QueryString(query)) == split_pairs(query) || fail("split", query);
+}
+
+// key, value and has_value of a pair, raw and decoded
+vector<string> param_fields(const QueryParam &p){
+  return { string(p.key.raw()), p.key.decoded(), string(p.value.raw()), p.value.decoded(), p.has_value ? "=" : "" };
+}
+
+// a body fed to one FormParser in random chunks, empty ones included, gives
+// the pairs of QueryString::append() on the whole body; with a small
+// max_pair, those before the first longer pair and then false. The parser
+// is reused after finish() for the next body
+bool form_case(mt19937 &rng, FormParser &parser, vector<vector<string>> &got, size_t max_pair){
+  string body = random_text(rng, "ab%41+&=", 0, 120);
+  vector<vector<string>> expected;
+  bool ok = true;
+  QueryString whole;
+
+  if(rng() % 8 == 0)
+    body = "k=%41&x";                             // split inside the escape below
+  whole.append(body);
+  for(const QueryParam &p : whole){
+    if(p.key.raw().size() + (p.has_value ? 1 + p.value.raw().size() : 0) > max_pair){
+      ok = false;
+      break;
+    }
+    expected.push_back(param_fields(p));
+  }
+
+  got.clear();
+  if(body == "k=%41&x"){
+    parser.feed(string_view(body).substr(0, 4));
+    parser.feed(string_view(body).substr(4));
+  } else {
+    for(size_t at = 0; at < body.size(); ){
+      size_t n = min<size_t>(rng() % 12, body.size() - at);
+      parser.feed(string_view(body).substr(at, n));
+      at += n;
+    }
+  }
+
+  return (parser.finish() == ok && got == expected) || fail("FormParser", body);
+}
+
+bool scan_case(mt19937 &rng){
+  string block = random_text(rng, "&=a\x80", 64, 64);
+  uint64_t amp, equ, amp_scalar, equ_scalar;
+
+  delimiters(block.data(), amp, equ);
+  delimiters_scalar(block.data(), 64, amp_scalar, equ_scalar);
+  return (amp == amp_scalar && equ == equ_scalar) || fail("delimiters()", block);
+}
+
+int main(int argc, char *argv[]){
+  long iterations = argc > 1 ? atol(argv[1]) : 100000;
+  mt19937 rng(argc > 2 ? atol(argv[2]) : 1);
+
+  for(long i = 0; i < iterations; ++i)
+    if(!scan_case(rng) || !well_formed_case(rng) || !arbitrary_case(rng))
+      return 1;
+
+  // an empty body has no pairs, then random bodies through the same parsers
+  for(size_t max_pair : { size_t(1) << 20, size_t(6) }){
+    vector<vector<string>> got;
+    FormParser parser([&](const QueryParam &p){ got.push_back(param_fields(p)); }, max_pair);
+
+    if(!parser.finish() || !got.empty()){
+      fail("FormParser", "");
+      return 1;
+    }
+    for(long i = 0; i < iterations; ++i)
+      if(!form_case(rng, parser, got, max_pair))
+        return 1;
+  }
+
+  cout << "ok, " << iterations << " rounds" << endl;
+  return 0;
+}
\ No newline at end of file
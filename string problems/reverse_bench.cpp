@@ -0,0 +1,61 @@
+// reverse_bench.cpp
+// author:  Joseph Perry
+// desc:    Measures in-place reversal of a large buffer: the add and subtract
+//          swap this directory used to have, std::reverse, and reverse_bytes()
+//          from reverse_string.h, then reverse_utf8() on ASCII text and on
+//          text where every other character is multi-byte. Build with -O2
+//          -march=native for the vector path.
+//
+//          usage: ./reverse_bench [megabytes]
+
+#include "reverse_string.h"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+// the original loop, swapping without a temporary
+void reverse_arithmetic(string &str){
+  for(size_t i = 0; i < str.length()/2; ++i){
+    str[i] = str[i] + str[str.length()-1-i];
+    str[str.length()-1-i] = str[i] - str[str.length()-1-i];
+    str[i] = str[i] - str[str.length()-1-i];
+  }
+}
+
+// reverses s an even number of times so it ends where it started
+template <typename F>
+void report(const char *name, string &s, F f){
+  const int rounds = 8;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  for(int r = 0; r < rounds; ++r)
+    f(s);
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  cout << name << ": " << s.size() * rounds << " bytes in " << seconds << " s, " << s.size() * rounds / seconds / 1e6 << " MB/sec (" << int(s[s.size() / 3]) << ")\n";
+}
+
+int main(int argc, char *argv[]){
+  size_t bytes = (argc > 1 ? atol(argv[1]) : 64) << 20;
+  mt19937 rng(1);
+  string text(bytes, ' ');
+
+  for(char &c : text)
+    c = 'a' + rng() % 26;
+
+  report("add and subtract swap", text, reverse_arithmetic);
+  report("std::reverse", text, [](string &s){ reverse(s.begin(), s.end()); });
+  report("reverse_bytes", text, [](string &s){ reverse_bytes(s); });
+  report("reverse_utf8, ASCII", text, [](string &s){ reverse_utf8(s); });
+
+  // alternating ASCII and two or three byte characters
+  string mixed;
+  while(mixed.size() < bytes){
+    mixed += 'a' + rng() % 26;
+    mixed += rng() % 2 ? "\xc3\xa9" : "\xe2\x82\xac";
+  }
+  report("reverse_utf8, mixed", mixed, [](string &s){ reverse_utf8(s); });
+
+  return 0;
+}
\ No newline at end of file
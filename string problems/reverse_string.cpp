@@ -1,32 +1,34 @@
 // reverse_string.cpp
 // author:  Joseph Perry
-// desc:    Reverses a given string or set of strings and outputs them to cout
+// desc:    Reverses a given string or set of strings and outputs them to cout,
+//          byte by byte or by UTF-8 code point (see reverse_string.h)
 
+#include "reverse_string.h"
 #include <iostream>
+#include <cstring>
 
-using namespace std;
-
-// Reverses a string in place without a temporary variable
-string reverse(string str){
-  size_t length = str.length();
+// usage: reverse_string [--utf8] strings...
+//   --utf8  reverse code points rather than bytes
+int main(int argc, char* argv[]){
+  string str = "hello world";
+  bool utf8 = false;
+  int first = 1;
 
-  if(length > 1){
-    for(int i = 0; i < length/2; ++i){
-      str[i] = str[i] + str[length-i-1];
-      str[length-i-1] = str[i] - str[length-i-1];
-      str[i] = str[i] - str[length-i-1];
-    }
+  if(argc > 1 && strcmp(argv[1], "--utf8") == 0){
+    utf8 = true;
+    first = 2;
   }
-  
-  return str;
-}
 
-int main(int argc, char* argv[]){
-  string str = "hello world";
+  if(argc > first)
+    for(int i = first; i < argc; ++i){
+      string reversed = argv[i];
 
-  if(argc > 1)
-    for(int i = 1; i < argc; ++i)
-      cout << argv[i] << endl << reverse(argv[i]) << endl;
+      if(utf8)
+        reverse_utf8(reversed);
+      else
+        reverse_bytes(reversed);
+      cout << argv[i] << endl << reversed << endl;
+    }
   else
     cout << str << " " << reverse(str) << endl;
 
@@ -0,0 +1,167 @@
+// reverse_string.h
+// author:  Joseph Perry
+// desc:    Reverses strings in place. reverse_bytes() swaps 16 or 32-byte
+//          blocks from the two ends, each reversed in a register with a byte
+//          shuffle (SSSE3 or AVX2 where the build allows). reverse_utf8()
+//          reverses the order of code points rather than bytes, so multi-byte
+//          characters stay intact. Grapheme clusters (a letter and its
+//          combining marks) are not kept together.
+
+#ifndef REVERSE_STRING_H
+#define REVERSE_STRING_H
+
+#include <string>
+#include <algorithm>
+#include <cstddef>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+#if defined(__SSSE3__)
+inline __m128i reverse16(__m128i v){
+  return _mm_shuffle_epi8(v, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+#endif
+
+#if defined(__AVX2__)
+// the shuffle only works within each 16-byte lane, so the lanes are swapped first
+inline __m256i reverse32(__m256i v){
+  __m256i lanes = _mm256_permute4x64_epi64(v, 0x4E);
+
+  return _mm256_shuffle_epi8(lanes, _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                                     15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+#endif
+
+// reverses p[0, n) byte by byte
+void reverse_bytes(char *p, size_t n){
+  size_t i = 0, j = n;
+
+#if defined(__AVX2__)
+  while(j - i >= 64){
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + j - 32));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), reverse32(b));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + j - 32), reverse32(a));
+    i += 32;
+    j -= 32;
+  }
+#endif
+
+#if defined(__SSSE3__)
+  while(j - i >= 32){
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + j - 16));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), reverse16(b));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p + j - 16), reverse16(a));
+    i += 16;
+    j -= 16;
+  }
+#endif
+
+  while(i + 1 < j)
+    swap(p[i++], p[--j]);
+}
+
+inline bool is_continuation(char c){ return (static_cast<unsigned char>(c) & 0xC0) == 0x80; }
+
+// end of the unit starting at p[i]: the byte and the continuation bytes after it
+inline size_t code_point_end(const char *p, size_t i, size_t n){
+  for(++i; i < n && is_continuation(p[i]); ++i);
+  return i;
+}
+
+#if defined(__SSSE3__)
+// reverses the bytes of each whole code point in the 16 bytes at p, which
+// starts on one, with one shuffle. A byte's source is start + end - 1 - k,
+// start from a running max of lead positions and end from a running min from
+// the right. Returns where the last code point in the block starts, which is
+// left as is, or 0 if the whole block is one run
+inline size_t reverse_code_points16(char *p){
+  const __m128i index = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  const __m128i sixteen = _mm_set1_epi8(16);
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  __m128i cont = _mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8(static_cast<char>(0xC0))), _mm_set1_epi8(static_cast<char>(0x80)));
+  unsigned leads = ~_mm_movemask_epi8(cont) & 0xFFFF;
+  size_t last = 31 - __builtin_clz(leads | 1);
+
+  if(last == 0)
+    return 0;
+
+  // byte 0 starts a code point even if it is a stray continuation byte
+  __m128i start = _mm_andnot_si128(cont, index);
+  start = _mm_max_epu8(start, _mm_slli_si128(start, 1));
+  start = _mm_max_epu8(start, _mm_slli_si128(start, 2));
+  start = _mm_max_epu8(start, _mm_slli_si128(start, 4));
+  start = _mm_max_epu8(start, _mm_slli_si128(start, 8));
+
+  __m128i end = _mm_or_si128(_mm_andnot_si128(cont, index), _mm_and_si128(cont, sixteen));
+  end = _mm_alignr_epi8(sixteen, end, 1);
+  end = _mm_min_epu8(end, _mm_alignr_epi8(sixteen, end, 1));
+  end = _mm_min_epu8(end, _mm_alignr_epi8(sixteen, end, 2));
+  end = _mm_min_epu8(end, _mm_alignr_epi8(sixteen, end, 4));
+  end = _mm_min_epu8(end, _mm_alignr_epi8(sixteen, end, 8));
+
+  __m128i source = _mm_sub_epi8(_mm_add_epi8(start, end), _mm_add_epi8(index, _mm_set1_epi8(1)));
+  __m128i whole = _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(last)), index);
+  source = _mm_or_si128(_mm_and_si128(whole, source), _mm_andnot_si128(whole, index));
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_shuffle_epi8(v, source));
+  return last;
+}
+#endif
+
+// reverses the order of the code points in p[0, n). Each code point's bytes
+// are reversed first, then the whole buffer, which puts them back in order.
+// A code point is taken as a byte and the continuation bytes after it, so
+// malformed input keeps every byte and only moves it as a unit
+void reverse_utf8(char *p, size_t n){
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  while(i + 16 <= n){
+    // ASCII needs no first pass, unless a stray continuation byte follows,
+    // which belongs with the last byte of the block
+    if(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))) == 0){
+      i += i + 16 < n && is_continuation(p[i + 16]) ? 15 : 16;
+      continue;
+    }
+
+    size_t done = 0;
+#if defined(__SSSE3__)
+    done = reverse_code_points16(p + i);
+#endif
+    if(done == 0){
+      size_t end = code_point_end(p, i, n);
+      std::reverse(p + i, p + end);
+      done = end - i;
+    }
+    i += done;
+  }
+#endif
+
+  while(i < n){
+    size_t end = code_point_end(p, i, n);
+
+    if(end - i > 1)
+      std::reverse(p + i, p + end);
+    i = end;
+  }
+
+  reverse_bytes(p, n);
+}
+
+inline void reverse_bytes(string &s){ reverse_bytes(&s[0], s.size()); }
+inline void reverse_utf8(string &s){ reverse_utf8(&s[0], s.size()); }
+
+// returns a reversed copy of str
+string reverse(string str){
+  reverse_bytes(str);
+  return str;
+}
+
+#endif